@@ -0,0 +1,73 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/aggregate.hpp"
+#include "../streamer/generate.hpp"
+#include "../streamer/join.hpp"
+#include "../streamer/map.hpp"
+#include "../streamer/reduce.hpp"
+#include "../streamer/vector.hpp"
+#include <cassert>
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/*
+ * aggregate(terminals...) passes the stream once through each of several terminals and
+ * returns a std::tuple of their results, in the same order. Any terminal which collects
+ * the elements one at a time may be used, such as item_count, minimum, fold, join,
+ * as_vector and as_map. The stream itself is only pulled once.
+ *
+ * Every terminal but the last is given a copy of each element, and the last is given
+ * the element itself, so a terminal which keeps the elements, such as as_vector, is best
+ * put last.
+ *
+ * aggregate cannot be used with an infinite stream.
+*/
+void example_aggregate() {
+    using namespace streamer;
+
+    std::vector<int> input = {56, 3, 23, 100, 42};
+
+    std::tuple<std::size_t, std::optional<int>, int, std::vector<int> > result = stream(input)
+        | aggregate(item_count, minimum, fold([](int a, int b) { return a + b; }, 0), as_vector);
+
+    auto [count, min, sum, values] = stream(input)
+        | filter([](int x) { return x > 10; })
+        | aggregate(item_count, minimum([](int a, int b) { return a > b; }),
+                    fold([](int a, int b) { return a + b; }, 0), as_vector);
+
+    std::tuple<std::string, std::map<std::string, std::size_t>, std::size_t> result2 = stream_of({"b", "aa", "ccc", "d"})
+        | mapping([](const char *s) { return std::string(s); })
+        | aggregate(join(", "), as_map([](const std::string &s) { return s; }, &std::string::size),
+                    item_count([](const std::string &s) { return s.size() > 1; }));
+
+    std::tuple<std::size_t, std::vector<int> > result3 = stream(std::vector<int>())
+        | aggregate(item_count, as_vector);
+
+    std::vector<int> big;
+    for(int i = 0; i < 10000; i++)
+        big.push_back(i);
+
+    std::tuple<std::size_t, long, std::vector<int> > result4 = stream(big)
+        | aggregate(item_count, fold([](long a, int b) { return a + b; }, 0L), as_vector);
+
+    try {
+        generator([]() { return 1; }) | aggregate(item_count, minimum);
+        assert(false);
+    } catch(const unbounded_stream &) {}
+
+
+    assert(std::get<0>(result) == 5);
+    assert(std::get<1>(result) == 3);
+    assert(std::get<2>(result) == 224);
+    assert(std::get<3>(result) == input);
+    assert(count == 4 && min == 100 && sum == 221);
+    assert(values == (std::vector<int>{56, 23, 100, 42}));
+    assert(std::get<0>(result2) == "b, aa, ccc, d");
+    assert(std::get<1>(result2).at("ccc") == 3 && std::get<1>(result2).size() == 4);
+    assert(std::get<2>(result2) == 2);
+    assert(std::get<0>(result3) == 0 && std::get<1>(result3).empty());
+    assert(std::get<0>(result4) == 10000 && std::get<1>(result4) == 49995000L && std::get<2>(result4) == big);
+}
@@ -0,0 +1,80 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/feed.hpp"
+#include "../streamer/generate.hpp"
+#include "../streamer/hyperloglog.hpp"
+#include "../streamer/order.hpp"
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * approx_distinct estimates the number of distinct elements in the stream with a
+ * HyperLogLog sketch, in a fixed amount of memory: 2^precision bytes.
+ * approx_distinct(precision) sets the precision, between 4 and 18 (14 by default, for
+ * 16KB and a standard error of about 0.8%). approx_distinct(KeyFunc, precision = 14)
+ * counts the distinct keys KeyFunc returns, which may be a member function or member
+ * variable. Keys are hashed with std::hash. After a parallel step, each thread fills its
+ * own sketch, and the sketches are merged.
+ *
+ * hyperloglog<T, Hash> is the sketch itself. insert(value) adds an element, count()
+ * returns the estimate and merge(other) adds in another sketch of the same precision,
+ * so sketches of separate parts or time windows of a stream can be combined. Used with
+ * feed, it counts the elements of an unbounded stream as they go past.
+ *
+ * approx_distinct throws unbounded_stream if the stream is unbounded.
+*/
+struct visit {
+    std::string user;
+    int page;
+};
+
+void example_approx_distinct() {
+    using namespace streamer;
+
+    std::vector<std::int64_t> input;
+    for(std::int64_t i = 0; i < 300000; i++)
+        input.push_back(i % 100000);
+
+    std::vector<visit> input2;
+    for(int i = 0; i < 20000; i++)
+        input2.push_back({"user" + std::to_string(i % 5000), i});
+
+    std::uint64_t result = stream(input)
+        | approx_distinct;
+
+    std::uint64_t result2 = stream(input2)
+        | approx_distinct(&visit::user, 12);
+
+    std::uint64_t result3 = stream(input)
+        | parallel(4)
+        | filter([](std::int64_t x) { return x % 2 == 0; })
+        | approx_distinct(10);
+
+    std::uint64_t result4 = stream(std::vector<int>{1, 2, 2, 3, 3, 3})
+        | approx_distinct;
+
+    hyperloglog<int> today;
+    hyperloglog<int> yesterday;
+    int counter = 0;
+    generator([&counter]() { return counter++ % 30000; })
+        | feed(today)
+        | take(100000)
+        | each([](int) {});
+
+    for(int i = 20000; i < 60000; i++)
+        yesterday.insert(i);
+    yesterday.merge(today);
+
+
+    auto near = [](std::uint64_t value, double expected, double error) {
+        return value > expected * (1 - error) && value < expected * (1 + error);
+    };
+
+    assert(near(result, 100000, 0.03));
+    assert(near(result2, 5000, 0.06));
+    assert(near(result3, 50000, 0.1));
+    assert(result4 == 3);
+    assert(near(today.count(), 30000, 0.03));
+    assert(near(yesterday.count(), 60000, 0.03));
+}
@@ -0,0 +1,58 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/flat_map.hpp"
+#include <cassert>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * as_flat_map(KeyFunc, ValueFunc) collects the elements of the stream into a
+ * flat_map, using KeyFunc(element) as the key and ValueFunc(element) as the value.
+ * Either may be a member function pointer or a pointer to a member variable.
+ * as_flat_map(KeyFunc) uses the element itself as the value, and
+ * as_flat_map(KeyFunc, ValueFunc, Comp) orders the keys by Comp instead of std::less.
+ *
+ * A flat_map is a vector of std::pair<K, V> sorted by key. Lookups are binary searches
+ * over contiguous memory, which makes it a good fit for tables which are built once
+ * and read often. The elements are gathered first and sorted once at the end, rather
+ * than inserted into a tree one at a time.
+ *
+ * as_flat_map throws a duplicate_map_key exception if multiple elements have equal
+ * keys. As with as_map, a final false argument keeps the first of them instead.
+ *
+ * as_flat_map cannot be used with an infinite stream.
+*/
+struct product {
+    int sku;
+    std::string title;
+};
+
+void example_as_flat_map() {
+    using namespace streamer;
+
+    std::vector<product> input = {{42, "lamp"}, {7, "desk"}, {19, "chair"}, {7, "stool"}};
+
+    flat_map<int, std::string> result = stream(input)
+        | as_flat_map(&product::sku, &product::title, false);
+
+    flat_map<std::string, product, std::greater<std::string> > result2 = stream(input)
+        | as_flat_map(&product::title, [](product p) { return p; }, std::greater<std::string>());
+
+    bool thrown = false;
+    try {
+        stream(input) | as_flat_map(&product::sku);
+    } catch(const duplicate_map_key &) {
+        thrown = true;
+    }
+
+
+    std::vector<std::pair<int, std::string> > expected = {{7, "desk"}, {19, "chair"}, {42, "lamp"}};
+
+    assert(result.values() == expected);
+    assert(result.at(19) == "chair");
+    assert(result.find(8) == result.end());
+    assert(result.lower_bound(8)->first == 19);
+    assert(result2.begin()->first == "stool");
+    assert(result2.at("lamp").sku == 42);
+    assert(thrown);
+}
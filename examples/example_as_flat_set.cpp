@@ -0,0 +1,63 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/flat_set.hpp"
+#include <cassert>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * as_flat_set collects the elements of the stream into a flat_set, a sorted vector
+ * without duplicates which is searched by binary search. as_sorted_vector collects
+ * them into a sorted std::vector and keeps duplicates, in stream order.
+ * Both gather the elements first and sort them once at the end.
+ *
+ * Both take the same arguments as as_set and as_multiset: as_flat_set(CompOrMem)
+ * orders the elements by a comparison functor, or by a member function or member
+ * variable, and as_flat_set(Mem, Comp) applies Comp to that member.
+ *
+ * as_flat_set throws a duplicate_set_key exception if multiple elements are considered
+ * equal. as_flat_set(false), as_flat_set(comp, false) or as_flat_set(&mem, comp, false)
+ * keep the first of them instead.
+ *
+ * as_flat_set and as_sorted_vector cannot be used with an infinite stream.
+*/
+struct version {
+    int major;
+    int minor;
+
+    bool operator==(const version &other) const { return major == other.major && minor == other.minor; }
+};
+
+void example_as_flat_set() {
+    using namespace streamer;
+
+    std::vector<int> input = {56, 3, 23, 100, 42};
+    std::vector<version> input2 = {{2, 1}, {1, 0}, {2, 0}, {1, 5}};
+
+    flat_set<int> result = stream(input)
+        | as_flat_set;
+
+    auto result2 = stream(input2)
+        | as_flat_set(&version::major, std::greater<int>(), false);
+
+    std::vector<version> result3 = stream(input2)
+        | as_sorted_vector(&version::major);
+
+    std::vector<int> result4 = stream(input)
+        | as_sorted_vector(std::greater<int>());
+
+    bool thrown = false;
+    try {
+        stream(input2) | as_flat_set(&version::major);
+    } catch(const duplicate_set_key &) {
+        thrown = true;
+    }
+
+
+    assert(result.values() == (std::vector<int>{3, 23, 42, 56, 100}));
+    assert(result.contains(42) && !result.contains(43));
+    assert(result2.values() == (std::vector<version>{{2, 1}, {1, 0}}));
+    assert(result3 == (std::vector<version>{{1, 0}, {1, 5}, {2, 1}, {2, 0}}));
+    assert(result4 == (std::vector<int>{100, 56, 42, 23, 3}));
+    assert(thrown);
+}
@@ -0,0 +1,53 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/hash_grouping.hpp"
+#include <cassert>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * as_hash_grouping(KeyFunc, ValueFunc) moves the elements in the stream into a
+ * std::unordered_map of std::vectors, appending ValueFunc(element) to the vector
+ * stored under KeyFunc(element). Within a group, the values are in the order of the
+ * stream. as_hash_grouping(KeyFunc) groups the elements themselves.
+ * KeyFunc and ValueFunc may be member function pointers or pointers to member variables.
+ *
+ * as_hash_grouping(KeyFunc, ValueFunc, Hash, Eq) uses Hash and Eq on the keys instead
+ * of std::hash and std::equal_to.
+ *
+ * as_flat_hash_grouping takes the same arguments and returns a flat_hash_map of
+ * std::vectors instead.
+ *
+ * as_hash_grouping and as_flat_hash_grouping cannot be used with an infinite stream.
+*/
+struct sale {
+    std::string region;
+    int amount;
+};
+
+void example_as_hash_grouping() {
+    using namespace streamer;
+
+    std::vector<sale> input = {{"north", 5}, {"south", 3}, {"north", 7}, {"east", 1}, {"south", 4}};
+
+    std::unordered_map<std::string, std::vector<int> > result = stream(input)
+        | as_hash_grouping(&sale::region, &sale::amount);
+
+    flat_hash_map<bool, std::vector<sale> > result2 = stream(input)
+        | as_flat_hash_grouping([](const sale &s) { return s.amount > 3; });
+
+    auto result3 = stream(input)
+        | as_flat_hash_grouping(&sale::region, &sale::amount,
+                                [](const std::string &s) { return s.size(); },
+                                [](const std::string &a, const std::string &b) { return a.size() == b.size(); });
+
+
+    assert(result.size() == 3);
+    assert(result.at("north") == (std::vector<int>{5, 7}));
+    assert(result.at("south") == (std::vector<int>{3, 4}));
+    assert(result.at("east") == (std::vector<int>{1}));
+    assert(result2.at(true).size() == 3);
+    assert(result2.at(false)[1].region == "east");
+    assert(result3.size() == 2);
+    assert(result3.at("xxxxx") == (std::vector<int>{5, 3, 7, 4}));
+}
@@ -3,8 +3,11 @@
 #include <algorithm>
 #include <array>
 #include <cassert>
+#include <utility>
+#include <vector>
 
 void example_as_map_basic();
+void example_as_map_key_copies();
 //void example_as_map_member_func();
 //void example_as_map_member_var();
 
@@ -27,10 +30,15 @@ void example_as_map_basic();
  * as_map(false), as_map(comp, false), or as_map(&mem, comp, false) may be used to
  * ignore duplicate elements.
  *
+ * A key given by a member variable, or by a member function returning a const
+ * reference, is looked at in place: it is copied once for each key stored in the map,
+ * and not at all for a duplicate.
+ *
  * as_map cannot be used with an infinite stream.
 */
 void example_as_map() {
     example_as_map_basic();
+    example_as_map_key_copies();
     //example_as_map_member_func();
     //example_as_map_member_var();
 }
@@ -165,3 +173,51 @@ void example_as_map_member_var() {
     assert(std::equal(result14.begin(), result14.end(), expected14.begin(), expected14.end()));
 }
 */
+
+
+// counts how many times a key is copied
+struct counted_key {
+    static inline int copies = 0;
+
+    explicit counted_key(int k) : id(k) {}
+    counted_key(const counted_key &other) : id(other.id) { copies++; }
+    counted_key(counted_key &&other) noexcept : id(other.id) {}
+    counted_key &operator=(const counted_key &other) { id = other.id; copies++; return *this; }
+    counted_key &operator=(counted_key &&other) noexcept { id = other.id; return *this; }
+
+    bool operator<(const counted_key &other) const { return id < other.id; }
+
+    int id;
+};
+
+struct order_line {
+    counted_key key;
+    int amount;
+
+    const counted_key &get_key() const { return key; }
+};
+
+void example_as_map_key_copies() {
+    using namespace streamer;
+
+    std::vector<order_line> input, input2;
+    for(int i = 0; i < 20; i++) {
+        input.push_back({counted_key(i % 5), i});
+        input2.push_back({counted_key(i % 5), i});
+    }
+
+    counted_key::copies = 0;
+    auto result = std::move(input)
+        | as_map(&order_line::key, &order_line::amount, false);
+    int copies = counted_key::copies;
+
+    counted_key::copies = 0;
+    auto result2 = std::move(input2)
+        | as_map(&order_line::get_key, &order_line::amount, false);
+    int copies2 = counted_key::copies;
+
+    assert(result.size() == 5 && copies == 5);
+    assert(result.begin()->first.id == 0 && result.begin()->second == 0);
+    assert(result2.size() == 5 && copies2 == 5);
+    assert(result2.rbegin()->second == 4);
+}
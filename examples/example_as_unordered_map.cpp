@@ -0,0 +1,80 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/unordered_map.hpp"
+#include <cassert>
+#include <cctype>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * as_unordered_map(KeyFunc, ValueFunc) moves the elements in the stream into a
+ * std::unordered_map, using KeyFunc(element) as the key and ValueFunc(element) as the
+ * value. Either may be a member function pointer or a pointer to a member variable.
+ * as_unordered_map(KeyFunc) uses the element itself as the value.
+ *
+ * as_unordered_map(KeyFunc, ValueFunc, Hash, Eq) uses Hash and Eq on the keys instead
+ * of std::hash and std::equal_to.
+ *
+ * as_flat_hash_map takes the same arguments but returns a flat_hash_map, which keeps
+ * all of its elements in one array instead of allocating a node for each of them.
+ * Its iterators are invalidated by every insert and erase, and its elements are
+ * std::pair<K, V> whose key must not be modified.
+ *
+ * Both throw a duplicate_map_key exception if multiple elements have equal keys. As
+ * with as_map, a final false argument keeps the first of them instead. If the size
+ * of the stream is known, room for that many keys is reserved up front.
+ *
+ * as_unordered_map and as_flat_hash_map cannot be used with an infinite stream.
+*/
+struct account {
+    std::string name;
+    int balance;
+};
+
+void example_as_unordered_map() {
+    using namespace streamer;
+
+    std::vector<account> input = {{"ann", 10}, {"bob", 25}, {"cat", 7}, {"Bob", 3}};
+
+    std::unordered_map<std::string, int> result = stream(input)
+        | as_unordered_map(&account::name, &account::balance);
+
+    auto lower = [](std::string s) {
+        for(char &c : s)
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return s;
+    };
+    auto hash = [lower](const std::string &s) { return std::hash<std::string>()(lower(s)); };
+    auto eq = [lower](const std::string &a, const std::string &b) { return lower(a) == lower(b); };
+
+    auto result2 = stream(input)
+        | as_flat_hash_map(&account::name, &account::balance, hash, eq, false);
+
+    flat_hash_map<int, account> result3 = stream(input)
+        | as_flat_hash_map(&account::balance);
+
+    bool thrown = false;
+    try {
+        stream(input)
+            | as_unordered_map([](const account &a) { return a.name.size(); }, &account::balance);
+    } catch(const duplicate_map_key &) {
+        thrown = true;
+    }
+
+    flat_hash_map<int, int> squares;
+    for(int i = 0; i < 1000; i++)
+        squares[i] = i * i;
+    for(int i = 0; i < 1000; i += 2)
+        squares.erase(i);
+
+
+    assert(result == (std::unordered_map<std::string, int>{{"ann", 10}, {"bob", 25}, {"cat", 7}, {"Bob", 3}}));
+    assert(result2.size() == 3);
+    assert(result2.at("BOB") == 25);
+    assert(result3.size() == 4);
+    assert(result3.at(7).name == "cat");
+    assert(result3.find(8) == result3.end());
+    assert(thrown);
+    assert(squares.size() == 500);
+    assert(!squares.contains(998) && squares.at(999) == 999 * 999);
+}
@@ -0,0 +1,64 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/unordered_set.hpp"
+#include <cassert>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * as_unordered_set moves the elements in the stream into a std::unordered_set and
+ * returns it. as_flat_hash_set does the same with a flat_hash_set, which keeps all
+ * of its elements in one array instead of allocating a node for each of them.
+ *
+ * as_unordered_set(Hash, Eq) uses Hash and Eq on the elements instead of std::hash
+ * and std::equal_to.
+ *
+ * as_unordered_set(KeyFunc) hashes and compares elements by KeyFunc(element), which
+ * may be a member function pointer or a pointer to a member variable.
+ *
+ * Both throw a duplicate_set_key exception if multiple elements are equal.
+ * as_unordered_set(false), as_unordered_set(key, false) or as_unordered_set(hash, eq, false)
+ * keep the first of them instead.
+ *
+ * as_unordered_set and as_flat_hash_set cannot be used with an infinite stream.
+*/
+struct tag_name {
+    std::string text;
+    int uses;
+};
+
+void example_as_unordered_set() {
+    using namespace streamer;
+
+    std::vector<int> input = {4, 8, 15, 16, 23, 42};
+    std::vector<int> input2 = {1, 2, 1, 3, 2, 1};
+    std::vector<tag_name> input3 = {{"c++", 10}, {"rust", 3}, {"c++", 5}};
+
+    std::unordered_set<int> result = stream(input)
+        | as_unordered_set;
+
+    flat_hash_set<int> result2 = stream(input2)
+        | as_flat_hash_set(false);
+
+    auto result3 = stream(input3)
+        | as_flat_hash_set(&tag_name::text, false);
+
+    auto result4 = stream(input2)
+        | as_unordered_set([](int x) { return std::hash<int>()(x % 2); },
+                           [](int a, int b) { return a % 2 == b % 2; }, false);
+
+    bool thrown = false;
+    try {
+        stream(input2) | as_unordered_set;
+    } catch(const duplicate_set_key &) {
+        thrown = true;
+    }
+
+
+    assert(result == (std::unordered_set<int>{4, 8, 15, 16, 23, 42}));
+    assert(result2.size() == 3 && result2.contains(1) && result2.contains(2) && result2.contains(3));
+    assert(result3.size() == 2);
+    assert(result3.find(tag_name{"c++", 0})->uses == 10);
+    assert(result4.size() == 2);
+    assert(thrown);
+}
@@ -1,13 +1,35 @@
+#include "../streamer/streamer.hpp"
 #include "../streamer/generate.hpp"
+#include "../streamer/order.hpp"
 #include "../streamer/vector.hpp"
 #include <array>
 #include <cassert>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
 
 /*
  * as_vector and as_vector() move the elements in the stream into a std::vector and returns the std::vector.
  * as_vector and as_vector() force the steps of the stream to be executed.
  * as_vector and as_vector() cannot be used with an infinite stream.
+ *
+ * Elements which are default constructible are pulled through the steps in batches,
+ * but no step is called for more elements than the result needs.
+ *
+ * When the number of elements is known in advance, as after mapping, skip or take over
+ * a container, the std::vector is allocated once with exactly that capacity.
 */
+struct labelled {
+    explicit labelled(int x) : label(std::to_string(x)) {}
+    std::string label;
+};
+
+// cannot be assigned to, so it is never batched
+struct ref_holder {
+    const int &ref;
+};
+
 void example_as_vector() {
     using namespace streamer;
 
@@ -19,6 +41,49 @@ void example_as_vector() {
     std::vector<int> result2 = input
         | as_vector();
 
+    std::vector<int> input2;
+    for(int i = 0; i < 1000; i++)
+        input2.push_back(i);
+
+    int calls = 0;
+    std::vector<int> result3 = input2
+        | mapping([&calls](int x) { calls++; return x + 1; })
+        | filter([](int x) { return x % 3 == 0; })
+        | skip(5)
+        | take(7)
+        | as_vector;
+
+    // labelled has no default constructor, so it is pulled one element at a time
+    std::vector<labelled> result4 = input2
+        | mapping([](int x) { return labelled(x); })
+        | skip(10)
+        | take(3)
+        | as_vector;
+
+    std::vector<int> result5 = input2
+        | mapping([](int x) { return x * 2; })
+        | as_vector;
+
+    std::vector<int> result6 = input2
+        | skip(400)
+        | as_vector;
+
+    std::vector<int> result7 = input2
+        | take(600)
+        | as_vector;
+
+    // the elements of a std::map have a const key, so they cannot be assigned to either
+    std::map<int, int> input3 = {{1, 10}, {2, 20}, {3, 30}};
+    std::size_t result8 = stream(input3) | item_count;
+    std::vector<std::pair<const int, int> > result9 = stream(input3) | as_vector;
+    std::vector<int> result10 = stream(input3)
+        | mapping([](const std::pair<const int, int> &p) { return p.second; })
+        | as_vector;
+    std::size_t result11 = input2
+        | mapping([&input2](int x) { return ref_holder{input2[x]}; })
+        | take(3)
+        | item_count;
+
     try {
         generator([]() { return 1; }) | as_vector;
         assert(false);
@@ -28,4 +93,14 @@ void example_as_vector() {
     std::vector<int> expected = {56, 3, 23, 100, 42};
     assert(result == expected);
     assert(result2 == expected);
+    assert(result3 == (std::vector<int>{18, 21, 24, 27, 30, 33, 36}));
+    assert(calls == 36);
+    assert(result4.size() == 3 && result4[0].label == "10" && result4[2].label == "12");
+    assert(result5.size() == 1000 && result5.capacity() == 1000 && result5.back() == 1998);
+    assert(result6.size() == 600 && result6.capacity() == 600 && result6.front() == 400);
+    assert(result7.size() == 600 && result7.capacity() == 600 && result7.back() == 599);
+    assert(result8 == 3);
+    assert(result9.size() == 3 && result9[2].first == 3 && result9[2].second == 30);
+    assert(result10 == (std::vector<int>{10, 20, 30}));
+    assert(result11 == 3);
 }
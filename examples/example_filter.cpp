@@ -1,10 +1,20 @@
 #include "../streamer/streamer.hpp"
+#include "../streamer/numeric.hpp"
+#include "../streamer/order.hpp"
 #include "../streamer/vector.hpp"
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <list>
+#include <string>
+#include <vector>
 
 /*
  * filter(UnaryPred) returns a stream consisting of the elements for which UnaryPred(x) is true.
+ *
+ * Small trivially copyable elements, such as numbers, are filtered a block at a time
+ * without a branch on UnaryPred(x), and straight from memory when the stream comes from
+ * a container such as a std::vector. UnaryPred is then called on a copy of the element.
 */
 void example_filter() {
     using namespace streamer;
@@ -15,6 +25,59 @@ void example_filter() {
         | filter([](auto x) { return x > 50; }) 
         | as_vector;
 
+    std::vector<int> input2;
+    for(int i = 0; i < 10000; i++)
+        input2.push_back((i * 7919) % 1000);
+
+    std::vector<int> result2 = stream(input2.data(), input2.size())
+        | filter([](int x) { return x % 3 == 0; })
+        | as_vector;
+
+    std::vector<int> result3 = stream(input2)
+        | filter([](int x) { return x % 3 == 0; })
+        | take(300)
+        | as_vector;
+
+    long result4 = stream(input2)
+        | filter([](int x) { return x > 900; })
+        | mapping([](int x) { return static_cast<long>(x) * 2; })
+        | sum;
+
+    std::list<int> input3(input2.begin(), input2.end());
+    std::vector<int> result5 = stream(input3)
+        | filter([](int x) { return x % 3 == 0; })
+        | as_vector;
+
+    std::vector<std::string> input4;
+    for(int i = 0; i < 1000; i++)
+        input4.push_back(std::to_string(i));
+
+    std::vector<std::string> result6 = stream(input4)
+        | filter([](const std::string &s) { return s.size() == 2; })
+        | as_vector;
+
+    std::vector<std::string> result7 = stream(input4)
+        | filter([](const std::string &s) { return s.back() == '7'; })
+        | take(3)
+        | as_vector;
+
     std::vector<int> expected = {56, 100};
+    std::vector<int> expected2;
+    for(int x : input2) {
+        if(x % 3 == 0)
+            expected2.push_back(x);
+    }
+
     assert(result == expected);
+    assert(result2 == expected2);
+    assert(result3.size() == 300 && std::equal(result3.begin(), result3.end(), expected2.begin()));
+    long expected4 = 0;
+    for(int x : input2) {
+        if(x > 900)
+            expected4 += x * 2;
+    }
+    assert(result4 == expected4);
+    assert(result5 == expected2);
+    assert(result6.size() == 90 && result6.front() == "10" && result6.back() == "99");
+    assert(result7 == (std::vector<std::string>{"7", "17", "27"}));
 }
@@ -63,7 +63,7 @@ void example_flat_mapping() {
 
     std::vector<std::string> names = families
         >> flat_mapping([](auto x) { 
-            return x.members 
+            return std::move(x.members) 
                 | mapping([](auto x) { return x.first_name + " " + x.last_name; }); 
             })
         >> as_vector;
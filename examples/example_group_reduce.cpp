@@ -0,0 +1,105 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/group_reduce.hpp"
+#include "../streamer/parallel.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * group_reduce(KeyFunc, init, op) folds the elements of each key into an accumulator of
+ * its own, which starts as a copy of init and is updated in place with
+ * acc = op(std::move(acc), element). It returns a std::map from each key to its
+ * accumulator, so only one accumulator per key is kept, rather than every element as
+ * with as_grouping. count_by(KeyFunc) returns the number of elements with each key.
+ * KeyFunc may be a member function pointer or a pointer to a member variable.
+ *
+ * hash_group_reduce and hash_count_by return a std::unordered_map instead, and
+ * flat_hash_group_reduce and flat_hash_count_by a flat_hash_map.
+ *
+ * After a parallel step, group_reduce(KeyFunc, init, op, combine) lets each thread fold
+ * its own chunks, with combine(acc1, acc2) joining the accumulators of a key from
+ * different chunks, in stream order. count_by always does this. Without a combine, the
+ * elements are passed to a thread picked by the hash of their key, which folds them in
+ * stream order, as as_map does after parallel. Every element is then held in memory until
+ * it is folded, as with as_grouping, so give a combine where op allows one. Keys without a
+ * std::hash are folded on a single thread. op and combine may be called from several
+ * threads at once.
+ *
+ * group_reduce and count_by cannot be used with an infinite stream.
+*/
+struct shipment {
+    std::string warehouse;
+    int items;
+};
+
+void example_group_reduce() {
+    using namespace streamer;
+
+    std::vector<shipment> input = {{"east", 5}, {"west", 3}, {"east", 7}, {"north", 1}, {"west", 4}};
+
+    std::map<std::string, int> result = stream(input)
+        | group_reduce(&shipment::warehouse, 0, [](int total, const shipment &s) { return total + s.items; });
+
+    std::map<std::string, std::size_t> result2 = stream(input)
+        | count_by(&shipment::warehouse);
+
+    std::unordered_map<bool, int> result3 = stream(input)
+        | hash_group_reduce([](const shipment &s) { return s.items > 3; }, 0,
+                            [](int most, const shipment &s) { return std::max(most, s.items); });
+
+    flat_hash_map<int, std::size_t> result4 = stream(input)
+        | flat_hash_count_by([](const shipment &s) { return s.items % 2; });
+
+    std::map<std::string, std::string> result5 = stream(input)
+        | group_reduce(&shipment::warehouse, std::string(),
+                       [](std::string s, const shipment &sh) { return s + std::to_string(sh.items); });
+
+
+    std::vector<int> numbers;
+    for(int i = 0; i < 50000; i++)
+        numbers.push_back((i * 7919) % 50000);
+
+    std::map<int, std::size_t> result6 = stream(numbers)
+        | parallel(4)
+        | count_by([](int x) { return x % 100; });
+
+    std::unordered_map<int, long> result7 = stream(numbers)
+        | parallel(3)
+        | hash_group_reduce([](int x) { return x % 7; }, 0L,
+                            [](long sum, int x) { return sum + x; }, std::plus<long>());
+
+    // op appends, which is not commutative, so the elements of a key must be folded in order
+    std::map<int, std::vector<int> > result8 = stream(numbers)
+        | parallel(4)
+        | group_reduce([](int x) { return x % 10; }, std::vector<int>(),
+                       [](std::vector<int> v, int x) { v.push_back(x); return v; });
+
+    std::map<int, std::vector<int> > result9 = stream(numbers)
+        | parallel(4)
+        | group_reduce([](int x) { return x % 10; }, std::vector<int>(),
+                       [](std::vector<int> v, int x) { v.push_back(x); return v; },
+                       [](std::vector<int> a, std::vector<int> b) { a.insert(a.end(), b.begin(), b.end()); return a; });
+
+    std::map<int, std::vector<int> > expected = stream(numbers)
+        | group_reduce([](int x) { return x % 10; }, std::vector<int>(),
+                       [](std::vector<int> v, int x) { v.push_back(x); return v; });
+
+
+    assert(result == (std::map<std::string, int>{{"east", 12}, {"north", 1}, {"west", 7}}));
+    assert(result2 == (std::map<std::string, std::size_t>{{"east", 2}, {"north", 1}, {"west", 2}}));
+    assert(result3.size() == 2 && result3.at(true) == 7 && result3.at(false) == 3);
+    assert(result4.size() == 2 && result4.at(1) == 4 && result4.at(0) == 1);
+    assert(result5.at("east") == "57" && result5.at("west") == "34");
+    assert(result6.size() == 100 && result6.at(0) == 500 && result6.at(99) == 500);
+    assert(result7.size() == 7);
+    long total = 0;
+    for(auto &entry : result7)
+        total += entry.second;
+    assert(total == 50000L * 49999 / 2);
+    assert(result8 == expected && result9 == expected);
+}
@@ -0,0 +1,80 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/feed.hpp"
+#include "../streamer/generate.hpp"
+#include "../streamer/heavy_hitters.hpp"
+#include "../streamer/order.hpp"
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * heavy_hitters(n) returns an std::vector of heavy_hitter<T> for the n most frequent
+ * elements of the stream, most frequent first. Each heavy_hitter has the key, its count
+ * and error: the count may be more than the real number of times the key was seen, by
+ * up to error, but never less. heavy_hitters(n, KeyFunc) counts the keys KeyFunc returns,
+ * which may be a member function or member variable. heavy_hitters(n, KeyFunc, capacity)
+ * sets the number of counters used, 10 * n (at least 64) by default.
+ *
+ * The counting uses the Space-Saving algorithm, in a fixed amount of memory: a key
+ * seen more often than (size of stream) / capacity times always gets counted. After a
+ * parallel step, each thread counts its own chunks and the counts are merged.
+ * heavy_hitters throws unbounded_stream if the stream is unbounded.
+ *
+ * space_saving<K> is the counter itself, and count_min<K> is a Count-Min sketch, which
+ * estimates the count of any key rather than keeping the top ones. Both have insert(key)
+ * and merge(other). Used with feed(sketch, KeyFunc), they count the keys of an unbounded
+ * stream as it goes past, and can be looked at while it runs.
+*/
+struct page_view {
+    std::string page;
+    int user;
+};
+
+void example_heavy_hitters() {
+    using namespace streamer;
+
+    std::vector<int> input = {1, 2, 3, 2, 3, 3, 4, 3, 2, 5};
+
+    std::vector<page_view> input2;
+    for(int i = 0; i < 100000; i++) {
+        std::string page = i % 3 == 0 ? "/home" : i % 5 == 0 ? "/search" : "/item" + std::to_string(i % 7919);
+        input2.push_back({page, i});
+    }
+
+    std::vector<heavy_hitter<int> > result = stream(input)
+        | heavy_hitters(2);
+
+    std::vector<heavy_hitter<std::string> > result2 = stream(input2)
+        | heavy_hitters(2, &page_view::page);
+
+    std::vector<heavy_hitter<std::string> > result3 = stream(input2)
+        | parallel(4)
+        | heavy_hitters(3, &page_view::page, 100);
+
+    space_saving<std::string> pages(100);
+    count_min<std::string> page_counts;
+    int counter = 0;
+    generator([&counter]() {
+            ++counter;
+            return page_view{counter % 2 == 0 ? "/hot" : "/cold" + std::to_string(counter), counter};
+        })
+        | feed(pages, &page_view::page)
+        | feed(page_counts, &page_view::page)
+        | take(10000)
+        | each([](const page_view &) {});
+
+    std::vector<heavy_hitter<std::string> > result4 = pages.top(1);
+
+
+    assert(result.size() == 2);
+    assert(result[0].key == 3 && result[0].count == 4 && result[0].error == 0);
+    assert(result[1].key == 2 && result[1].count == 3);
+    assert(result2[0].key == "/home" && result2[0].count == 33334);
+    assert(result2[1].key == "/search" && result2[1].count == 13333);
+    assert(result3[0].key == "/home" && result3[1].key == "/search");
+    assert(result3[0].count >= 33334 && result3[0].count - result3[0].error <= 33334);
+    assert(result4[0].key == "/hot" && result4[0].count >= 5000);
+    assert(page_counts.estimate("/hot") >= 5000 && page_counts.estimate("/hot") < 5100);
+    assert(page_counts.estimate("/cold1") < 100);
+}
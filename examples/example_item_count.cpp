@@ -1,13 +1,19 @@
 #include "../streamer/generate.hpp"
 #include "../streamer/streamer.hpp"
+#include "../streamer/order.hpp"
 #include <array>
 #include <cassert>
+#include <list>
+#include <vector>
 
 /*
  * item_count and item_count() return a count of how many elements are in the stream.
  * item_count(UnaryPred) returns a count of how many elements match UnaryPred.
  * item_count, item_count() and item_count(UnaryPred) force execution of the stream.
  * item_count, item_count() and item_count(UnaryPred) cannot be used with an infinite stream.
+ *
+ * Over a container with random access, such as a std::vector, item_count takes the size
+ * of the container without reading the elements, even after a mapping.
 */
 void example_item_count() {
     using namespace streamer;
@@ -18,6 +24,19 @@ void example_item_count() {
     std::size_t result2 = input >> item_count();
     std::size_t result3 = input % item_count([](auto x) { return x > 50; }); 
 
+    std::vector<int> input2(1000, 1);
+    int calls = 0;
+    std::size_t result4 = input2
+        | mapping([&calls](int x) { calls++; return x; })
+        | skip(10)
+        | item_count;
+
+    std::list<int> input3(input2.begin(), input2.end());
+    std::size_t result5 = input3
+        | mapping([](int x) { return x; })
+        | skip(10)
+        | item_count;
+
 
     try {
         generator([]() { return 1; }) | item_count;
@@ -31,5 +50,7 @@ void example_item_count() {
 
     assert(result == 5);
     assert(result2 == 5);
-    assert(result3 = 2);
+    assert(result3 == 2);
+    assert(result4 == 990 && calls == 0);
+    assert(result5 == 990);
 }
@@ -1,6 +1,7 @@
 #include "../streamer/generate.hpp"
 #include "../streamer/streamer.hpp"
 #include <cassert>
+#include <list>
 #include <vector>
 
 /*
@@ -10,7 +11,8 @@
  * last(UnaryPred) returns the last element in the stream matching the predicate, or 
  * an empty std::optional if no elements match the predicate.
  *
- * last cannot be used with an infinite stream.
+ * last cannot be used with an infinite stream. Over a container with random access, such
+ * as a std::vector, last reads only the last element, even after a mapping.
 */
 void example_last() {
     using namespace streamer;
@@ -28,6 +30,16 @@ void example_last() {
     std::optional<int> result2 = input >> last;
     std::optional<int> no_result2 = empty_input >> last();
 
+    int calls = 0;
+    std::optional<int> result3 = input
+        | mapping([&calls](int x) { calls++; return x + 1; })
+        | last;
+
+    std::list<int> input2(input.begin(), input.end());
+    std::optional<int> result4 = input2
+        | mapping([](int x) { return x + 1; })
+        | last;
+
 
     try {
         generator([]() { return 1; }) | last;
@@ -44,4 +56,6 @@ void example_last() {
     assert(!no_result);
     assert(result2.value() == 4);
     assert(!no_result2);
+    assert(result3 == 5 && calls == 1);
+    assert(result4 == 5);
 }
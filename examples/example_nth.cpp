@@ -0,0 +1,91 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/nth.hpp"
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*
+ * nth(k) returns the element which would be at index k if the stream were sorted, or an
+ * empty std::optional if the stream has k elements or fewer. median() returns the
+ * element in the middle of the sorted stream; for an even number of elements, the lower
+ * of the two middle ones. It is empty for an empty stream.
+ *
+ * percentiles({p1, p2, ...}) returns an std::vector with, for each fraction p between 0
+ * and 1, the element at index p * (size - 1), rounded down, of the sorted stream. It is
+ * empty for an empty stream, and throws std::invalid_argument for a p outside [0, 1].
+ *
+ * Each of these can be given a comparison functor or a member function or member
+ * variable to order by: nth(k, Comp), median(Comp), percentiles(Comp, {p...}), and a
+ * member with a comparison: nth(k, Mem, Comp), median(Mem, Comp),
+ * percentiles(Mem, Comp, {p...}).
+ *
+ * The elements are collected into a vector, then only partly sorted until the wanted
+ * positions are in place, which is linear time on average. Several percentiles share
+ * one vector, and each only searches the part after the one before it.
+ *
+ * nth, median and percentiles throw unbounded_stream if the stream is unbounded.
+*/
+struct req {
+    std::string path;
+    std::int64_t latency;
+};
+
+void example_nth() {
+    using namespace streamer;
+
+    std::vector<int> input = {56, 3, 23, 100, 42, 3, 77};
+    std::vector<req> input2 = {{"/a", 30}, {"/b", 500}, {"/c", 25}, {"/d", 120}, {"/e", 7}, {"/f", 60}};
+
+    std::optional<int> result = stream(input)
+        | nth(2);
+
+    std::optional<int> result2 = stream(input)
+        | nth(0, std::greater<int>());
+
+    std::optional<int> result3 = stream(input)
+        | nth(7);
+
+    std::optional<int> result4 = stream(input)
+        | median;
+
+    std::optional<req> result5 = stream(input2)
+        | median(&req::latency);
+
+    std::vector<std::int64_t> latencies;
+    for(std::int64_t i = 1; i <= 1000; i++)
+        latencies.push_back((i * 7919) % 1000 + 1);
+
+    std::vector<std::int64_t> result6 = stream(latencies)
+        | percentiles({0.99, 0.5, 0.9, 0.0, 1.0});
+
+    std::vector<req> result7 = stream(input2)
+        | percentiles(&req::latency, {0.5, 1.0});
+
+    std::vector<req> result8 = stream(input2)
+        | percentiles(&req::path, std::greater<std::string>(), {0.0});
+
+    std::vector<int> result9 = stream(std::vector<int>())
+        | percentiles({0.5});
+
+    bool threw = false;
+    try {
+        percentiles({1.5});
+    } catch(const std::invalid_argument &) {
+        threw = true;
+    }
+
+
+    assert(result == 23);
+    assert(result2 == 100);
+    assert(!result3);
+    assert(result4 == 42);
+    assert(result5->path == "/a");
+    assert(result6 == (std::vector<std::int64_t>{990, 500, 900, 1, 1000}));
+    assert(result7[0].path == "/a" && result7[1].path == "/b");
+    assert(result8[0].path == "/f");
+    assert(result9.empty());
+    assert(threw);
+}
@@ -0,0 +1,93 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/aggregate.hpp"
+#include "../streamer/generate.hpp"
+#include "../streamer/numeric.hpp"
+#include "../streamer/reduce.hpp"
+#include "../streamer/vector.hpp"
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/*
+ * sum, minmax and mean are terminals for streams of arithmetic elements:
+ *
+ * sum returns the sum of the elements, with char and short elements added up as ints.
+ * minmax returns a std::optional std::pair of the smallest and largest element, or an
+ * empty std::optional if there are none. mean returns their average as a
+ * std::optional<double>, adding them up as doubles, or as 64-bit integers if they are
+ * integers.
+ *
+ * When the elements come straight from memory, as with a std::vector, a std::array, a
+ * pointer and a size or a C array, they are read from there directly. Otherwise they
+ * are read in batches, as after a filter. On x86 processors with AVX2, float, double
+ * and 32 and 64-bit integer elements are handled several at a time with SIMD
+ * instructions, and other processors use a plain loop. minimum does the same for
+ * arithmetic elements, when no Comp is given.
+ *
+ * Floating point elements are not added in stream order, so the rounding of sum and
+ * mean may differ slightly from that of fold. A NaN is skipped by minimum and minmax
+ * unless it is the first element, as with minimum(Comp).
+ *
+ * sum, minmax and mean cannot be used with an infinite stream.
+*/
+void example_numeric() {
+    using namespace streamer;
+
+    std::vector<float> input;
+    for(int i = 0; i < 10000; i++)
+        input.push_back(static_cast<float>((i * 7919) % 1000));
+
+    float result = stream(input) | sum;
+    std::optional<std::pair<float, float> > result2 = stream(input) | minmax;
+    std::optional<double> result3 = stream(input) | mean;
+    std::optional<float> result4 = stream(input) | minimum;
+
+    std::array<std::int32_t, 7> ints = {5, -3, 40, 7, -3, 12, 1};
+    std::int32_t result5 = ints | sum;
+    std::optional<std::pair<std::int32_t, std::int32_t> > result6 = stream(ints) | minmax();
+    std::optional<double> result7 = stream(ints.data(), ints.size()) | mean();
+
+    int result8 = stream_of({'a', 'b'}) | sum;
+    std::optional<std::pair<double, double> > result9 = stream(std::vector<double>{2.5, std::nan(""), -1.0, 9.0})
+        | minmax;
+    std::optional<int> result10 = stream(std::vector<int>()) | minimum;
+
+    long result11 = range(1L, 100001L)
+        | filter([](long x) { return x % 2 == 0; })
+        | sum;
+
+    auto [total, extremes, average] = stream(input)
+        | filter([](float x) { return x < 500.0f; })
+        | aggregate(sum, minmax, mean);
+
+    std::vector<std::uint64_t> big(100000, std::numeric_limits<std::uint64_t>::max() / 50000);
+    std::uint64_t result12 = stream(big) | sum;
+
+    try {
+        generator([]() { return 1; }) | sum;
+        assert(false);
+    } catch(const unbounded_stream &) {}
+
+
+    assert(result == 4995000.0f);
+    assert(result2 && result2->first == 0.0f && result2->second == 999.0f);
+    assert(result3 == 499.5);
+    assert(result4 == 0.0f);
+    assert(result5 == 59);
+    assert(result6 && result6->first == -3 && result6->second == 40);
+    assert(result7 && std::abs(*result7 - 59.0 / 7) < 1e-12);
+    assert(result8 == 'a' + 'b');
+    assert(result9 && result9->first == -1.0 && result9->second == 9.0);
+    assert(!result10);
+    assert(!(stream(std::vector<double>()) | mean));
+    assert(result11 == 2500050000L);
+    assert(total == 1247500.0f && extremes && extremes->first == 0.0f && extremes->second == 499.0f);
+    assert(average == 249.5);
+    assert(result12 == (std::numeric_limits<std::uint64_t>::max() / 50000) * 100000);
+}
@@ -0,0 +1,83 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/order.hpp"
+#include "../streamer/generate.hpp"
+#include "../streamer/parallel.hpp"
+#include "../streamer/vector.hpp"
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * parallel(threads = hardware_concurrency, keep_order = true) splits the rest of the
+ * stream into chunks and runs the steps which follow it on several threads.
+ * parallel(pool, keep_order = true) uses the threads of a thread_pool instead of
+ * starting new ones, so the pool can be shared by many streams.
+ *
+ * The mapping, flat_mapping, filter, exclude and copied steps after parallel run on
+ * the chunks. The first other step collects the results (in the original order, unless
+ * keep_order is false) and runs on the calling thread as usual. The functions passed
+ * to the parallel steps must therefore be safe to call from several threads at once.
+ *
+ * If the stream does not come from a random-access container or iterators, it is
+ * read into a vector first. An exception thrown on any thread is rethrown by the
+ * step which collects the results.
+ *
+ * parallel throws unbounded_stream if the stream is unbounded.
+*/
+void example_parallel() {
+    using namespace streamer;
+
+    std::vector<int> input;
+    for(int i = 0; i < 10000; i++)
+        input.push_back(i);
+
+    std::vector<std::string> result = stream(input)
+        | parallel(4)
+        | filter([](auto x) { return x % 3 == 0; })
+        | mapping([](auto x) { return std::to_string(x); })
+        | take(4)
+        | as_vector;
+
+    thread_pool pool(3);
+
+    std::vector<int> result2 = stream(input)
+        | filter([](auto x) { return x % 1000 == 0; })
+        | parallel(pool)
+        | flat_mapping([](auto x) { return std::vector<int>{x, x + 1}; })
+        | exclude([](auto x) { return x % 2 == 1 && x > 5000; })
+        | as_vector;
+
+    std::vector<int> result3 = stream(input)
+        | parallel(pool, false)
+        | mapping([](auto x) { return x * 2; })
+        | as_vector;
+
+    bool thrown = false;
+    try {
+        stream(input)
+            | parallel(pool)
+            | mapping([](auto x) { if(x == 5000) throw std::runtime_error("5000"); return x; })
+            | as_vector;
+    } catch(const std::runtime_error &) {
+        thrown = true;
+    }
+
+    bool unbounded_thrown = false;
+    try {
+        generator([]() { return 1; }) | parallel(2);
+    } catch(const unbounded_stream &) {
+        unbounded_thrown = true;
+    }
+
+
+    std::vector<std::string> expected = {"0", "3", "6", "9"};
+    std::vector<int> expected2 = {0, 1, 1000, 1001, 2000, 2001, 3000, 3001, 4000, 4001,
+        5000, 6000, 7000, 8000, 9000};
+
+    assert(result == expected);
+    assert(result2 == expected2);
+    assert(result3.size() == input.size());
+    assert(thrown);
+    assert(unbounded_thrown);
+}
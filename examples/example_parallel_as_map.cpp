@@ -0,0 +1,124 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/parallel.hpp"
+#include "../streamer/map.hpp"
+#include "../streamer/grouping.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * as_map, as_multimap and as_grouping after a parallel step build their std::map on
+ * several threads. Each thread sorts the elements of its chunk by the hash of their
+ * keys into shards. Each shard is then collected into a map of its own by one thread,
+ * and the shard maps are merged into the result without copying their nodes.
+ *
+ * Elements with the same key always end up in the same shard in their original
+ * order, so the result is the same as without parallel: as_map keeps the first of
+ * several equal keys or throws duplicate_map_key, and the values of a group are in
+ * stream order.
+ *
+ * The key type needs a std::hash specialization, and the map must use the default
+ * std::less, so that keys which are equal for the map have the same hash. Keys without
+ * a std::hash, and maps given a Comp of their own, are collected on the calling thread
+ * instead.
+ *
+ * The key and value functions are called from several threads at once.
+*/
+struct customer {
+    int id;
+    std::string region;
+};
+
+struct ci_less {
+    bool operator()(const std::string &a, const std::string &b) const {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+            return std::tolower(static_cast<unsigned char>(x)) < std::tolower(static_cast<unsigned char>(y));
+        });
+    }
+};
+
+void example_parallel_as_map() {
+    using namespace streamer;
+
+    std::vector<customer> input;
+    for(int i = 0; i < 20000; i++)
+        input.push_back({(i * 7919) % 20000, "r" + std::to_string(i % 13)});
+
+    std::map<int, std::string> result = stream(input)
+        | parallel(4)
+        | as_map(&customer::id, &customer::region);
+
+    std::map<int, std::string> expected = stream(input)
+        | as_map(&customer::id, &customer::region);
+
+    thread_pool pool(3);
+
+    std::map<std::string, std::vector<int> > result2 = stream(input)
+        | parallel(pool)
+        | as_grouping(&customer::region, &customer::id);
+
+    std::map<std::string, std::vector<int> > expected2 = stream(input)
+        | as_grouping(&customer::region, &customer::id);
+
+    std::vector<int> duplicates = {5, 3, 5, 8, 3};
+
+    std::map<int, int> result3 = stream(duplicates)
+        | parallel(pool)
+        | mapping([](int x) { return std::make_pair(x, x * 10); })
+        | as_map([](const auto &p) { return p.first; }, [](auto p) { return p.second; }, false);
+
+    bool thrown = false;
+    try {
+        stream(input)
+            | parallel(pool)
+            | as_map(&customer::region);
+    } catch(const duplicate_map_key &) {
+        thrown = true;
+    }
+
+    // std::pair has no std::hash, so this is collected on one thread
+    std::multimap<std::pair<int, int>, int> result4 = stream(duplicates)
+        | parallel(2)
+        | as_multimap([](int x) { return std::make_pair(x % 2, x); });
+
+    // "R1" and "r1" are the same key for ci_less, but not for std::hash
+    std::vector<std::string> regions;
+    for(int i = 0; i < 10000; i++)
+        regions.push_back((i / 50 % 2 ? "R" : "r") + std::to_string(i % 50));
+
+    std::map<std::string, std::vector<std::string>, ci_less> result5 = stream(regions)
+        | parallel(4)
+        | as_grouping([](const std::string &s) { return s; }, [](const std::string &s) { return s; }, ci_less());
+
+    bool thrown2 = false;
+    try {
+        stream(regions)
+            | parallel(4)
+            | as_map([](const std::string &s) { return s; }, [](const std::string &s) { return s; }, ci_less());
+    } catch(const duplicate_map_key &) {
+        thrown2 = true;
+    }
+
+    // a comparator without a default constructor
+    auto descending = [](int a, int b) { return a > b; };
+    auto result6 = stream(input)
+        | parallel(4)
+        | as_map(&customer::id, &customer::region, descending);
+
+
+    assert(result == expected);
+    assert(result.size() == 20000);
+    assert(result2 == expected2);
+    assert(result3 == (std::map<int, int>{{3, 30}, {5, 50}, {8, 80}}));
+    assert(thrown);
+    assert(result4.size() == 5);
+    assert(result4.begin()->first == std::make_pair(0, 8));
+    assert(result5.size() == 50);
+    assert(result5.at("R7").size() == 200 && result5.at("r7").front() == "r7" && result5.at("r7")[1] == "R7");
+    assert(thrown2);
+    assert(result6.size() == 20000 && result6.begin()->first == 19999);
+}
@@ -0,0 +1,68 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/parallel.hpp"
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*
+ * parallel_fold(BiFunc func, T init, Combine combine, threads = hardware_concurrency)
+ * splits the stream into chunks and folds each chunk on its own thread, starting from a
+ * copy of init: acc = func(std::move(acc), element). The results of the chunks are then
+ * combined in pairs with combine(left, right), left being the result of the earlier
+ * elements. parallel_fold(func, init, combine, pool) uses the threads of a thread_pool.
+ *
+ * Since init is used once per chunk, it must not change the result when combined, and
+ * combine must be associative (such as 0 with +, or an empty string with string
+ * concatenation). The chunks are combined in the same order every time for the same
+ * number of threads, so floating point results are repeatable.
+ *
+ * parallel_reduce(BiFunc func, threads = hardware_concurrency) does the same without
+ * an initial value, using func to combine the chunks too. It returns an
+ * std::optional which is empty if the stream is empty. parallel_reduce(func, pool)
+ * uses the threads of a thread_pool.
+ *
+ * After a parallel step, parallel_fold and parallel_reduce work directly on the
+ * parallel chunks and use the threads given to parallel.
+ *
+ * func and combine are called from several threads at once. parallel_fold and
+ * parallel_reduce throw unbounded_stream if the stream is unbounded.
+*/
+void example_parallel_fold() {
+    using namespace streamer;
+
+    std::vector<std::int64_t> input;
+    for(std::int64_t i = 1; i <= 100000; i++)
+        input.push_back(i);
+
+    std::vector<std::string> words = {"a", "b", "c", "d", "e", "f", "g"};
+
+    std::int64_t result = stream(input)
+        | parallel_fold([](std::int64_t acc, std::int64_t x) { return acc + x * x; },
+                        std::int64_t(0),
+                        [](std::int64_t a, std::int64_t b) { return a + b; },
+                        4);
+
+    thread_pool pool(3);
+
+    std::string result2 = stream(words)
+        | parallel_fold([](std::string acc, const std::string &x) { return acc + x; },
+                        std::string(),
+                        [](std::string a, std::string b) { return a + b; },
+                        pool);
+
+    std::optional<std::int64_t> result3 = stream(input)
+        | parallel(pool)
+        | filter([](auto x) { return x % 7 == 0; })
+        | parallel_reduce([](std::int64_t a, std::int64_t b) { return a > b ? a : b; });
+
+    std::optional<int> result4 = stream(std::vector<int>())
+        | parallel_reduce([](int a, int b) { return a + b; }, 2);
+
+
+    assert(result == 333338333350000);
+    assert(result2 == "abcdefg");
+    assert(result3 == 99995);
+    assert(!result4);
+}
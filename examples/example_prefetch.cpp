@@ -0,0 +1,94 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/generate.hpp"
+#include "../streamer/order.hpp"
+#include "../streamer/prefetch.hpp"
+#include "../streamer/reduce.hpp"
+#include "../streamer/vector.hpp"
+#include <cassert>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * prefetch(capacity) runs the steps before it on a thread of its own, which keeps up to
+ * capacity elements (1024 by default, rounded up to a power of 2) ready for the steps
+ * after it. A slow source or mapping then works on the next elements while the rest of
+ * the stream handles the previous ones. The elements are passed between the threads
+ * through a ring buffer, without locks, unless one of the threads has to wait for the
+ * other.
+ *
+ * The thread is started when the first element is pulled. If a step before the prefetch
+ * throws, the exception is rethrown after it, once the elements before it have been
+ * handed out. If the stream stops early, as with take or take_while, or is destroyed
+ * before it is used up, the thread stops and is joined. A take after the prefetch also
+ * stops the thread after that many elements, so no more are made than are used.
+ *
+ * The steps before a prefetch must not use anything the steps after it use without
+ * synchronization.
+*/
+void example_prefetch() {
+    using namespace streamer;
+
+    std::vector<int> result = generator(0, [](int x) { return x + 1; })
+        | prefetch(16)
+        | take(100)
+        | as_vector;
+
+    std::vector<std::string> result2 = range(0, 10000)
+        | mapping([](int x) { return std::to_string(x); })
+        | prefetch()
+        | filter([](const std::string &s) { return s.size() == 2; })
+        | as_vector;
+
+    long result3 = range(0L, 100000L)
+        | mapping([](long x) { return x * 3; })
+        | prefetch(64)
+        | fold([](long a, long b) { return a + b; }, 0L);
+
+    int made = 0;
+    std::vector<int> result4 = generator([&made]() { return made++; })
+        | prefetch(8)
+        | take_while([](int x) { return x < 50; })
+        | as_vector;
+
+    // elements with a const key are handed over one at a time
+    std::map<int, std::string> input = {{1, "a"}, {2, "b"}, {3, "c"}};
+    std::vector<std::pair<const int, std::string> > result5 = stream(input)
+        | prefetch(2)
+        | as_vector;
+
+    std::vector<int> seen;
+    try {
+        auto failing = range(0, 100)
+            | mapping([](int x) {
+                if(x == 20)
+                    throw std::runtime_error("bad element");
+                return x;
+            })
+            | prefetch(4);
+        for(int x : failing)
+            seen.push_back(x);
+        assert(false);
+    } catch(const std::runtime_error &e) {
+        assert(std::string(e.what()) == "bad element");
+    }
+
+    {
+        auto unused = range(0, 1000000) | prefetch(32);
+        assert(*unused.begin() == 0);
+    }
+
+    try {
+        prefetch(0);
+        assert(false);
+    } catch(const std::invalid_argument &) {}
+
+
+    assert(result.size() == 100 && result.front() == 0 && result.back() == 99);
+    assert(result2.size() == 90 && result2.front() == "10" && result2.back() == "99");
+    assert(result3 == 3L * (99999L * 100000L / 2));
+    assert(result4.size() == 50 && result4.back() == 49);
+    assert(seen.size() == 20 && seen.back() == 19);
+    assert(result5.size() == 3 && result5[0].first == 1 && result5[2].second == "c");
+}
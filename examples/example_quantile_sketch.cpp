@@ -0,0 +1,78 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/feed.hpp"
+#include "../streamer/generate.hpp"
+#include "../streamer/order.hpp"
+#include "../streamer/quantile_sketch.hpp"
+#include <cassert>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+/*
+ * quantile_sketch(accuracy = 0.01) returns a kll_sketch<T> of the elements of the
+ * stream, from which approximate quantiles can be read: quantile(q) returns the element
+ * at about fraction q of the way through the sorted elements, quantiles({q...}) several
+ * at once, and rank(value) about the fraction of elements less than value. An element
+ * returned for q is usually within accuracy of rank q, and the smallest and largest
+ * elements (q = 0 and q = 1) are exact.
+ *
+ * The sketch keeps a number of elements which depends on accuracy, not on the size of
+ * the stream, and sketches with the same accuracy can be combined with merge(). After a
+ * parallel step, each thread sketches its own chunks and the sketches are merged.
+ * quantile_sketch throws unbounded_stream if the stream is unbounded.
+ *
+ * feed(sketch) passes every element on unchanged, inserting it into sketch on the way.
+ * It works on unbounded streams, and the sketch can be read while the stream is running.
+ * feed works with any sketch which has an insert(element) member function.
+*/
+void example_quantile_sketch() {
+    using namespace streamer;
+
+    std::vector<std::int64_t> input;
+    for(std::int64_t i = 0; i < 100000; i++)
+        input.push_back((i * 7919) % 100000);
+
+    kll_sketch<std::int64_t> result = stream(input)
+        | quantile_sketch();
+
+    std::vector<std::int64_t> result2 = result.quantiles({0.5, 0.9, 0.99, 0.0, 1.0});
+
+    kll_sketch<std::int64_t> result3 = stream(input)
+        | parallel(4)
+        | filter([](std::int64_t x) { return x < 50000; })
+        | quantile_sketch(0.02);
+
+    std::optional<std::int64_t> result4 = result3.quantile(0.5);
+
+    kll_sketch<int> latencies;
+    int counter = 0;
+    int checks = 0;
+    generator([&counter]() { ++counter; return counter % 1000; })
+        | feed(latencies)
+        | take_while([&](int) { return counter < 50000; })
+        | each([&](int) {
+            if(counter % 10000 == 0) {
+                std::optional<int> p50 = latencies.quantile(0.5);
+                assert(p50 && *p50 > 470 && *p50 < 530);
+                checks++;
+            }
+        });
+
+    kll_sketch<int> merged = latencies;
+    merged.merge(latencies);
+
+    kll_sketch<int> result5 = stream(std::vector<int>())
+        | quantile_sketch();
+
+
+    auto near = [](std::int64_t value, std::int64_t expected) { return value > expected - 1500 && value < expected + 1500; };
+
+    assert(result.size() == 100000 && result.retained() < 1000);
+    assert(near(result2[0], 50000) && near(result2[1], 90000) && near(result2[2], 99000));
+    assert(result2[3] == 0 && result2[4] == 99999);
+    assert(result.rank(25000) > 0.24 && result.rank(25000) < 0.26);
+    assert(result3.size() == 50000 && result4 && near(*result4, 25000));
+    assert(checks == 4 && latencies.size() == 50000);
+    assert(merged.size() == 100000 && merged.retained() < 1000);
+    assert(result5.empty() && !result5.quantile(0.5));
+}
@@ -1,11 +1,17 @@
+#include "../streamer/streamer.hpp"
 #include "../streamer/order.hpp"
 #include "../streamer/vector.hpp"
 #include <array>
 #include <cassert>
+#include <list>
+#include <vector>
 
 /*
  * skip(n) skips the first n elements in the stream. If the stream has fewer than n elements,
  * then the resulting stream is now empty.
+ *
+ * Over a container with random access, such as a std::vector, the skipped elements are
+ * stepped over without being read, even after a mapping, which is not called for them.
 */
 void example_skip() {
     using namespace streamer;
@@ -24,6 +30,22 @@ void example_skip() {
         | skip(10)
         | as_vector;
 
+    std::vector<int> input2;
+    for(int i = 0; i < 1000; i++)
+        input2.push_back(i);
+    std::list<int> input3(input2.begin(), input2.end());
+
+    int calls = 0;
+    std::vector<int> result4 = input2
+        | mapping([&calls](int x) { calls++; return x * 2; })
+        | skip(995)
+        | as_vector;
+
+    std::vector<int> result5 = input3
+        | mapping([](int x) { return x * 2; })
+        | skip(995)
+        | as_vector;
+
     std::vector<int> expected = {100, 42};
     std::vector<int> expected2 = {56, 3, 23, 100, 42};
     std::vector<int> expected3 = {};
@@ -31,4 +53,6 @@ void example_skip() {
     assert(result == expected);
     assert(result2 == expected2);
     assert(result3 == expected3);
+    assert(result4 == (std::vector<int>{1990, 1992, 1994, 1996, 1998}) && calls == 5);
+    assert(result5 == result4);
 }
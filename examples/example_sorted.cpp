@@ -0,0 +1,166 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/order.hpp"
+#include "../streamer/sorted.hpp"
+#include "../streamer/vector.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+/*
+ * sorted sorts the elements of the stream. sorted(Comp) sorts them by a comparison
+ * functor, sorted(Mem) by a member function or member variable, and
+ * sorted(KeyFunc, Comp) by applying Comp to KeyFunc(element). The sort is stable:
+ * equal elements keep their order in the stream.
+ *
+ * sorted only reads and sorts the stream once its first element is asked for.
+ * With a KeyFunc or Mem, the key of each element is worked out once, rather than in
+ * every comparison. Integer and floating point keys (or elements) ordered by std::less
+ * or std::greater are sorted with a radix sort.
+ *
+ * sorted(threads), sorted(Comp, threads), sorted(Mem, threads) and
+ * sorted(KeyFunc, Comp, threads) sort other large inputs on up to threads threads. Comp
+ * and KeyFunc may then be called from several threads at once. Without threads, sorted
+ * runs on the calling thread only.
+ *
+ * Followed by take(n) or first, sorted only keeps the n smallest elements while
+ * reading the stream, and only sorts those. When elements are pulled one at a time,
+ * as by an iterator, they come off a heap, so stopping early skips most of the sort.
+ *
+ * sorted cannot be used with an infinite stream.
+*/
+struct event {
+    std::int64_t timestamp;
+    std::string name;
+
+    const std::string &get_name() const { return name; }
+};
+
+void example_sorted() {
+    using namespace streamer;
+
+    std::vector<int> input = {56, -3, 23, 100, -42, 0};
+    std::vector<double> input2 = {2.5, -0.5, 1e10, -1e10, 0.0, 3.25};
+    std::vector<event> input3 = {{30, "c"}, {10, "b"}, {20, "a"}, {10, "a"}};
+
+    std::vector<int> result = stream(input)
+        | sorted
+        | as_vector;
+
+    std::vector<double> result2 = stream(input2)
+        | sorted(std::greater<double>())
+        | as_vector;
+
+    std::vector<event> result3 = stream(input3)
+        | sorted(&event::timestamp)
+        | as_vector;
+
+    std::vector<event> result4 = stream(input3)
+        | sorted(&event::get_name, std::greater<std::string>())
+        | as_vector;
+
+    std::vector<std::string> result5 = stream(input3)
+        | sorted([](const event &a, const event &b) { return a.name.size() + a.timestamp < b.name.size() + b.timestamp; })
+        | mapping(&event::name)
+        | as_vector;
+
+    // large enough to be sorted on several threads
+    std::vector<std::string> big;
+    for(int i = 0; i < 200000; i++)
+        big.push_back(std::to_string((i * 7919) % 200000));
+
+    std::vector<std::string> result6 = stream(big)
+        | sorted(4)
+        | as_vector;
+
+    std::vector<std::string> expected6 = big;
+    std::stable_sort(expected6.begin(), expected6.end());
+
+    std::vector<std::int64_t> big2;
+    for(std::int64_t i = 0; i < 100000; i++)
+        big2.push_back((i * 7919) % 100000 - 50000);
+
+    std::vector<std::int64_t> result7 = stream(big2)
+        | sorted
+        | as_vector;
+
+    std::vector<std::int64_t> result8 = stream(big2)
+        | sorted(std::greater<std::int64_t>())
+        | take(3)
+        | as_vector;
+
+    std::vector<std::string> result9 = stream(big)
+        | sorted
+        | skip(10)
+        | take(3)
+        | as_vector;
+
+    std::vector<std::string> result10 = stream(input3)
+        | sorted(&event::timestamp)
+        | mapping(&event::name)
+        | take(2)
+        | as_vector;
+
+    std::optional<int> result11 = stream(input)
+        | sorted
+        | first;
+
+    std::vector<std::string> result12;
+    for(const event &e : stream(input3) | sorted(&event::timestamp))
+        result12.push_back(e.name);
+
+    // -0.0 and 0.0 are equal, so they keep their order
+    std::vector<double> result13 = stream(std::vector<double>{0.0, -0.0, 1.0, -0.0, -1.0})
+        | sorted
+        | as_vector;
+
+    std::vector<float> result14 = stream(std::vector<float>{-0.0f, 2.0f, 0.0f})
+        | sorted(std::greater<float>())
+        | as_vector;
+
+    // each key is worked out once, also when only a few elements are kept or pulled
+    std::size_t keys = 0;
+    auto counted_key = [&keys](const std::string &s) { keys++; return s; };
+    std::vector<std::string> result15 = stream(big)
+        | sorted(counted_key, std::less<std::string>())
+        | take(3)
+        | as_vector;
+    std::size_t keys15 = keys;
+
+    keys = 0;
+    std::vector<std::string> result16;
+    for(const std::string &s : stream(big) | sorted(counted_key, std::less<std::string>())) {
+        result16.push_back(s);
+        if(result16.size() == 3)
+            break;
+    }
+
+    std::vector<std::string> result17 = stream(big)
+        | sorted(std::greater<std::string>(), 4)
+        | as_vector;
+
+
+    assert(result == (std::vector<int>{-42, -3, 0, 23, 56, 100}));
+    assert(result2 == (std::vector<double>{1e10, 3.25, 2.5, 0.0, -0.5, -1e10}));
+    assert(result3[0].name == "b" && result3[1].name == "a" && result3[2].name == "a" && result3[3].name == "c");
+    assert(result4[0].name == "c" && result4[1].name == "b" && result4[2].timestamp == 20 && result4[3].timestamp == 10);
+    assert(result5 == (std::vector<std::string>{"b", "a", "a", "c"}));
+    assert(result6 == expected6);
+    assert(std::is_sorted(result7.begin(), result7.end()) && result7.size() == 100000 && result7.front() == -50000);
+    assert(result8 == (std::vector<std::int64_t>{49999, 49998, 49997}));
+    assert(result9 == std::vector<std::string>(expected6.begin() + 10, expected6.begin() + 13));
+    assert(result10 == (std::vector<std::string>{"b", "a"}));
+    assert(result11 == -42);
+    assert(result12 == (std::vector<std::string>{"b", "a", "a", "c"}));
+    assert(result13 == (std::vector<double>{-1.0, 0.0, 0.0, 0.0, 1.0}));
+    assert(!std::signbit(result13[1]) && std::signbit(result13[2]) && std::signbit(result13[3]));
+    assert(result14 == (std::vector<float>{2.0f, 0.0f, 0.0f}));
+    assert(std::signbit(result14[1]) && !std::signbit(result14[2]));
+    assert(result15 == std::vector<std::string>(expected6.begin(), expected6.begin() + 3) && keys15 == big.size());
+    assert(result16 == result15 && keys == big.size());
+    assert(std::equal(result17.begin(), result17.end(), expected6.rbegin(), expected6.rend()));
+}
@@ -0,0 +1,92 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/generate.hpp"
+#include "../streamer/order.hpp"
+#include "../streamer/reduce.hpp"
+#include "../streamer/stage.hpp"
+#include "../streamer/vector.hpp"
+#include <cassert>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+ * stage() splits a stream into parts which run at the same time, each on a thread of its
+ * own, like the stations of an assembly line. The steps between two stage()s, or between
+ * the start of the stream and the first stage(), make up one part, and the steps after
+ * the last stage() run on the calling thread as usual:
+ *
+ *     input | mapping(decode) | stage() | filter(check) | stage() | mapping(enrich) | as_vector
+ *
+ * runs decode on one thread, check on a second and enrich and as_vector on the calling
+ * thread. A stream made of parts which take about as long as each other runs up to that
+ * many times faster, given enough cores.
+ *
+ * Each stage() passes the elements on in chunks through a ring of up to capacity elements
+ * (1024 by default, rounded up to a power of 2). When the ring is full, the part before
+ * it waits for the part after it to catch up. stage(capacity, cpu) also keeps the thread
+ * on the given cpu, on Linux. stage() works the same way as prefetch, so exceptions are
+ * passed on and the threads stop when the stream stops early or is destroyed.
+ *
+ * The steps of different parts must not use anything the steps of the others use
+ * without synchronization.
+*/
+struct reading {
+    int sensor;
+    double value;
+};
+
+void example_stage() {
+    using namespace streamer;
+
+    std::vector<std::string> input;
+    for(int i = 0; i < 20000; i++)
+        input.push_back(std::to_string(i % 7) + ":" + std::to_string(i % 101));
+
+    std::vector<std::string> result = stream(input)
+        | mapping([](const std::string &line) {
+            std::size_t colon = line.find(':');
+            return reading{std::stoi(line.substr(0, colon)), std::stod(line.substr(colon + 1))};
+        })
+        | stage()
+        | filter([](const reading &r) { return r.value >= 50.0; })
+        | stage(256)
+        | mapping([](const reading &r) { return "sensor " + std::to_string(r.sensor); })
+        | as_vector;
+
+    long result2 = range(0L, 100000L)
+        | mapping([](long x) { return x * 2; })
+        | stage(64, 0)
+        | filter([](long x) { return x % 3 == 0; })
+        | stage(64, 0)
+        | fold([](long a, long b) { return a + b; }, 0L);
+
+    std::vector<int> result3 = range(0, 1000000)
+        | stage(16)
+        | mapping([](int x) { return x + 1; })
+        | stage(16)
+        | take(10)
+        | as_vector;
+
+    try {
+        stream(input)
+            | mapping([](const std::string &line) { return std::stoi(line.substr(line.find(':') + 1)); })
+            | stage()
+            | mapping([](int x) {
+                if(x == 100)
+                    throw std::range_error("too large");
+                return x;
+            })
+            | stage()
+            | as_vector;
+        assert(false);
+    } catch(const std::range_error &) {}
+
+
+    assert(result.size() == 10098);
+    assert(result[0] == "sensor 1" && result[1] == "sensor 2");
+    long expected2 = 0;
+    for(long x = 0; x < 200000L; x += 6)
+        expected2 += x;
+    assert(result2 == expected2);
+    assert(result3 == (std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+}
@@ -0,0 +1,59 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/order.hpp"
+#include "../streamer/vector.hpp"
+#include <array>
+#include <cassert>
+#include <string>
+#include <vector>
+
+/*
+ * stream_fused(...) accepts the same arguments as stream(...), but creates a fused_t
+ * instead of a streamer_t. The steps mapping, flat_mapping, filter, exclude, take, skip,
+ * take_while and skip_while applied to a fused_t are kept in its type instead of being
+ * allocated on the heap and called through a virtual function, so the compiler is able
+ * to inline the whole chain.
+ *
+ * Any other step (such as as_vector) first calls erase() on the fused_t, which
+ * returns an ordinary streamer_t that wraps the whole fused chain.
+*/
+void example_stream_fused() {
+    using namespace streamer;
+
+    std::array<int, 8> input = {56, 3, 23, 100, 42, 7, 18, 91};
+    std::vector<std::string> input2 = {"56", "3", "2334", "100", "42"};
+
+    std::vector<int> result = stream_fused(input)
+        | filter([](auto x) { return x % 2 == 0; })
+        | mapping([](auto x) { return x / 2; })
+        | as_vector;
+
+    std::vector<int> result2 = stream_fused(input.begin() + 1, input.end())
+        >> skip(2)
+        >> take(4)
+        >> as_vector();
+
+    std::vector<std::string::size_type> result3 = stream_fused(std::move(input2))
+        % mapping(&std::string::length)
+        % skip_while([](auto x) { return x < 3; })
+        % take_while([](auto x) { return x > 2; })
+        % as_vector;
+
+    streamer_t<int> erased = (stream_fused(input)
+        | flat_mapping([](auto x) { return std::vector<int>(x % 3, x); })
+        | exclude([](auto x) { return x > 50; })
+        | take(5)).erase();
+
+    std::vector<int> result4 = std::move(erased)
+        | as_vector;
+
+
+    std::vector<int> expected = {28, 50, 21, 9};
+    std::vector<int> expected2 = {100, 42, 7, 18};
+    std::vector<std::string::size_type> expected3 = {4, 3};
+    std::vector<int> expected4 = {23, 23, 7};
+
+    assert(result == expected);
+    assert(result2 == expected2);
+    assert(result3 == expected3);
+    assert(result4 == expected4);
+}
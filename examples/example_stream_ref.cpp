@@ -0,0 +1,65 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/order.hpp"
+#include "../streamer/vector.hpp"
+#include <cassert>
+#include <string>
+#include <vector>
+
+/*
+ * stream_ref(Cont&), stream_ref(It, It) and stream_ref(const T *p, n) create a stream of 
+ * borrowed<T> which refer to the elements instead of copying them. The elements must 
+ * exist for the duration of the stream's life, so stream_ref cannot be used with a 
+ * temporary container.
+ *
+ * borrowed<T> implicitly converts to const T&, so predicates and functions taking 
+ * a const T& work unchanged. get() and -> also give access to the element.
+ *
+ * mapping(&T::member) on a stream of borrowed<T> gives a stream of borrowed<U> referring 
+ * to the member. filter, take, skip, first and the other steps pass the references along
+ * without copying the elements.
+ *
+ * copied turns a stream of borrowed<T> into a stream of T, copying each element.
+*/
+
+struct log_record {
+    int level;
+    std::string source;
+    std::string message;
+};
+
+
+void example_stream_ref() {
+    using namespace streamer;
+
+    std::vector<log_record> input = {
+        {1, "db", "connected"},
+        {3, "http", "timeout"},
+        {2, "db", "slow query"},
+        {3, "db", "deadlock"}
+    };
+
+    std::vector<std::string> result = stream_ref(input)
+        | filter([](const log_record &r) { return r.level == 3; })
+        | mapping(&log_record::message)
+        | copied
+        | as_vector;
+
+    std::vector<borrowed<log_record> > result2 = stream_ref(input)
+        | skip(1)
+        | filter([](const auto &r) { return r->source == "db"; })
+        | as_vector;
+
+    std::optional<borrowed<std::string> > result3 = stream_ref(input.data(), 2)
+        | mapping(&log_record::source)
+        | skip(1)
+        | first;
+
+
+    std::vector<std::string> expected = {"timeout", "deadlock"};
+
+    assert(result == expected);
+    assert(result2.size() == 2);
+    assert(&result2[0].get() == &input[2]);
+    assert(&result2[1].get() == &input[3]);
+    assert(&result3->get() == &input[1].source);
+}
@@ -1,11 +1,16 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/generate.hpp"
 #include "../streamer/order.hpp"
 #include "../streamer/vector.hpp"
 #include <array>
 #include <cassert>
+#include <optional>
+#include <vector>
 
 /*
  * take(n) limits the stream to n elements. If the stream has more than n elements,
- * only the first n elements are returned.
+ * only the first n elements are returned. Once the n elements have been taken, the
+ * steps before take are not called again, so take may also end an infinite stream.
 */
 void example_take() {
     using namespace streamer;
@@ -24,6 +29,29 @@ void example_take() {
         | take(10)
         | as_vector;
 
+    std::vector<int> input2(1000, 7);
+
+    int calls = 0;
+    std::vector<int> result4 = input2
+        | mapping([&calls](int x) { calls++; return x; })
+        | take(3)
+        | as_vector;
+
+    int calls2 = 0;
+    std::vector<int> result5 = input2
+        | mapping([&calls2](int x) { calls2++; return x; })
+        | take(0)
+        | as_vector;
+
+    int calls3 = 0;
+    std::optional<int> result6 = input2
+        | mapping([&calls3](int x) { calls3++; return x; })
+        | first;
+
+    std::vector<int> result7 = generator(0, [](int x) { return x + 2; })
+        | take(4)
+        | as_vector;
+
     std::vector<int> expected = {56, 3, 23};
     std::vector<int> expected2 = {};
     std::vector<int> expected3 = {56, 3, 23, 100, 42};
@@ -31,4 +59,8 @@ void example_take() {
     assert(result == expected);
     assert(result2 == expected2);
     assert(result3 == expected3);
+    assert(result4 == (std::vector<int>{7, 7, 7}) && calls == 3);
+    assert(result5.empty() && calls2 == 0);
+    assert(result6 == 7 && calls3 == 1);
+    assert(result7 == (std::vector<int>{0, 2, 4, 6}));
 }
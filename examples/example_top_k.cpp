@@ -0,0 +1,90 @@
+#include "../streamer/streamer.hpp"
+#include "../streamer/generate.hpp"
+#include "../streamer/order.hpp"
+#include "../streamer/top_k.hpp"
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+ * top_k(k) returns an std::vector of the k largest elements of the stream, largest
+ * first. bottom_k(k) returns the k smallest, smallest first. If the stream has fewer
+ * than k elements, all of them are returned.
+ *
+ * top_k(k, Comp) and bottom_k(k, Comp) order the elements by a comparison functor or,
+ * given a member function or member variable, by that member. top_k(k, Mem, Comp) and
+ * bottom_k(k, Mem, Comp) apply Comp to the member. Equal elements keep their order in
+ * the stream, as with a stable sort.
+ *
+ * Only k elements are held at any time, so top_k and bottom_k can be used on very large
+ * streams, or on an infinite stream cut short by take or take_while. After a parallel
+ * step, each thread keeps its own k elements, which are merged at the end.
+ *
+ * top_k and bottom_k throw unbounded_stream if the stream is unbounded.
+*/
+struct request {
+    std::string path;
+    std::int64_t latency;
+};
+
+void example_top_k() {
+    using namespace streamer;
+
+    std::vector<int> input = {56, 3, 23, 100, 42, 3, 77};
+    std::vector<request> input2 = {{"/a", 30}, {"/b", 500}, {"/c", 30}, {"/d", 120}, {"/e", 7}};
+
+    std::vector<int> result = stream(input)
+        | top_k(3);
+
+    std::vector<int> result2 = stream(input)
+        | bottom_k(3);
+
+    std::vector<request> result3 = stream(input2)
+        | top_k(2, &request::latency);
+
+    std::vector<request> result4 = stream(input2)
+        | bottom_k(3, &request::latency, std::less<std::int64_t>());
+
+    std::vector<std::string> result5 = stream(input)
+        | mapping([](int x) { return std::to_string(x); })
+        | top_k(2, [](const std::string &a, const std::string &b) { return a.size() < b.size(); });
+
+    std::vector<int> result6 = stream(input)
+        | top_k(0);
+
+    std::vector<int> result7 = stream(input)
+        | bottom_k(100);
+
+    int counter = 0;
+    std::vector<int> result8 = generator([&counter]() { ++counter; return (counter * 7919) % 1000; })
+        | take(1000)
+        | top_k(3);
+
+    std::vector<std::int64_t> big;
+    for(std::int64_t i = 0; i < 100000; i++)
+        big.push_back((i * 7919) % 100000);
+
+    std::vector<std::int64_t> result9 = stream(big)
+        | parallel(4)
+        | filter([](std::int64_t x) { return x % 2 == 1; })
+        | top_k(3);
+
+    std::vector<std::int64_t> result10 = stream(big)
+        | parallel(3)
+        | mapping([](std::int64_t x) { return x % 10; })
+        | bottom_k(4);
+
+
+    assert(result == (std::vector<int>{100, 77, 56}));
+    assert(result2 == (std::vector<int>{3, 3, 23}));
+    assert(result3[0].path == "/b" && result3[1].path == "/d");
+    assert(result4[0].path == "/e" && result4[1].path == "/a" && result4[2].path == "/c");
+    assert(result5 == (std::vector<std::string>{"100", "56"}));
+    assert(result6.empty());
+    assert(result7 == (std::vector<int>{3, 3, 23, 42, 56, 77, 100}));
+    assert(result8 == (std::vector<int>{999, 998, 997}));
+    assert(result9 == (std::vector<std::int64_t>{99999, 99997, 99995}));
+    assert(result10 == (std::vector<std::int64_t>{0, 0, 0, 0}));
+}
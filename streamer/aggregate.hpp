@@ -0,0 +1,173 @@
+#ifndef STREAMER_AGGREGATE_HPP
+#define STREAMER_AGGREGATE_HPP
+
+#include "base.hpp"
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+template<typename Collector, typename = void>
+struct reservable : std::false_type {};
+
+template<typename Collector>
+struct reservable<Collector, std::void_t<decltype(std::declval<Collector&>().reserve(size_hint()))> >
+    : std::true_type {};
+
+
+// gives every element to each of Collectors, in order. all but the last get a copy of
+// it, and the last gets the element itself. a collector which returns false gets
+// nothing more, and the stream stops once they all have.
+template<typename T, typename... Collectors>
+class aggregate_collector : public sink<T> {
+public:
+    aggregate_collector(Collectors &&...c) : cols(std::move(c)...), open(), copies() { open.fill(true); }
+
+    bool on_next(T &&value) override {
+        return next(value, std::index_sequence_for<Collectors...>());
+    }
+
+    bool on_batch(T *values, std::size_t n) override {
+        return next_batch(values, n, std::index_sequence_for<Collectors...>());
+    }
+
+    void on_done() override {
+        std::apply([](auto &...col) { (col.on_done(), ...); }, cols);
+    }
+
+    void reserve(size_hint hint) {
+        std::apply([hint](auto &...col) { (reserve_one(col, hint), ...); }, cols);
+    }
+
+    auto result() {
+        return std::apply([](auto &...col) { return std::make_tuple(col.result()...); }, cols);
+    }
+
+private:
+    template<std::size_t I>
+    using collector_at = typename std::tuple_element<I, std::tuple<Collectors...> >::type;
+
+    static constexpr std::size_t last = sizeof...(Collectors) - 1;
+
+    template<typename Collector>
+    static void reserve_one(Collector &col, size_hint hint) {
+        if constexpr(reservable<Collector>::value)
+            col.reserve(hint);
+    }
+
+    template<std::size_t... I>
+    bool next(T &value, std::index_sequence<I...>) {
+        // in order, as the last collector moves from value
+        bool any = false;
+        ((any = give<I>(value) || any), ...);
+        return any;
+    }
+
+    template<std::size_t I>
+    bool give(T &value) {
+        if(!open[I])
+            return false;
+
+        using Collector = collector_at<I>;
+        Collector &col = std::get<I>(cols);
+        if constexpr(I == last) {
+            open[I] = col.Collector::on_next(std::move(value));
+        } else {
+            T copy(value);
+            open[I] = col.Collector::on_next(std::move(copy));
+        }
+        return open[I];
+    }
+
+    template<std::size_t... I>
+    bool next_batch(T *values, std::size_t n, std::index_sequence<I...>) {
+        bool any = false;
+        ((any = give_batch<I>(values, n) || any), ...);
+        return any;
+    }
+
+    // copies the batch for each collector but the last, so that collectors such as
+    // item_count and as_vector still see whole batches
+    template<std::size_t I>
+    bool give_batch(T *values, std::size_t n) {
+        if(!open[I])
+            return false;
+
+        using Collector = collector_at<I>;
+        Collector &col = std::get<I>(cols);
+        if constexpr(I == last) {
+            open[I] = col.Collector::on_batch(values, n);
+        } else {
+            copies.clear();
+            for(std::size_t i = 0; i < n; i++)
+                copies.push_back(values[i]);
+            open[I] = col.Collector::on_batch(copies.data(), n);
+        }
+        return open[I];
+    }
+
+    std::tuple<Collectors...> cols;
+    std::array<bool, sizeof...(Collectors)> open;
+    std::vector<T> copies;
+};
+
+
+template<typename T, typename... Collectors>
+aggregate_collector<T, Collectors...> make_aggregate_collector(Collectors &&...cols) {
+    return aggregate_collector<T, Collectors...>(std::move(cols)...);
+}
+
+
+template<typename... Steps>
+class aggregate_t : public step_wrapper<aggregate_t<Steps...> > {
+public:
+    aggregate_t(Steps &&...s) : steps(std::move(s)...) {}
+
+    template<typename T>
+    auto stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use aggregate on an unbounded stream");
+
+        auto out = collector<T>();
+        out.reserve(s->hint());
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    auto collector() {
+        return std::apply([](auto &...step) {
+            return make_aggregate_collector<T>(step.template collector<T>()...);
+        }, steps);
+    }
+
+private:
+    std::tuple<Steps...> steps;
+};
+
+
+}  // namespace detail
+
+
+
+// passes the stream once through several terminals, such as item_count, minimum, fold
+// and as_vector, and returns a std::tuple of their results. every terminal but the last
+// works on copies of the elements.
+template<typename... Steps>
+auto aggregate(Steps... steps) {
+    static_assert(sizeof...(Steps) > 0, "aggregate needs at least one terminal");
+    return detail::aggregate_t<Steps...>(std::move(steps)...);
+}
+
+
+} // namespace streamer
+
+#endif
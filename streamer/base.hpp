@@ -160,6 +160,28 @@ auto stream_move(Cont &cont) {
 
 
 
+template<typename It>
+auto stream_ref(It begin, It end) {
+    using T = typename detail::remove_ref_cv<decltype(*begin)>::type;
+    return streamer_t<borrowed<T> >(begin, end);
+}
+
+template<typename T>
+streamer_t<borrowed<T> > stream_ref(const T *p, std::size_t n) {
+    return stream_ref(p, p + n);
+}
+
+template<typename Cont>
+auto stream_ref(Cont &cont) {
+    return stream_ref(std::begin(cont), std::end(cont));
+}
+
+// the elements would not outlive the stream
+template<typename Cont>
+void stream_ref(const Cont &&) = delete;
+
+
+
 template<typename Cont, typename Step>
 auto operator>>(Cont &&cont, detail::step_wrapper<Step> &step) {
     auto st = stream(std::forward<Cont>(cont));
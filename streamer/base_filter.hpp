@@ -18,6 +18,39 @@ public:
 namespace detail {
 
 
+// small trivially copyable elements are selected without a branch per element: each one
+// is copied to the next free place whether it passes or not, and only the count of
+// those kept depends on the predicate, so there is nothing to mispredict
+template<typename T>
+struct branchless_select : std::integral_constant<bool,
+    std::is_trivially_copyable<T>::value && batchable<T>::value && sizeof(T) <= 32> {};
+
+
+// moves the elements of from[0, n) which pass pred to out, in order, and returns how
+// many there were. out may be from.
+template<typename UnaryPred, typename Src, typename T>
+std::size_t select_into(UnaryPred &pred, Src *from, T *out, std::size_t n) {
+    std::size_t kept = 0;
+    if constexpr(branchless_select<T>::value) {
+        for(std::size_t i = 0; i < n; i++) {
+            T value = from[i];
+            bool keep = static_cast<bool>(pred(value));
+            out[kept] = value;
+            kept += keep;
+        }
+    } else {
+        for(std::size_t i = 0; i < n; i++) {
+            if(pred(from[i])) {
+                if(out + kept != from + i)
+                    out[kept] = std::move(from[i]);
+                kept++;
+            }
+        }
+    }
+    return kept;
+}
+
+
 template<typename UnaryPred, typename T>
 class filter_step : public step<T> {
 public:
@@ -31,13 +64,103 @@ public:
         }
         return {};
     }
+
+    std::size_t get_batch(T *out, std::size_t n) override {
+        if constexpr(batchable<T>::value) {
+            std::size_t kept = 0;
+            while(kept < n) {
+                std::size_t wanted = n - kept;
+                if(select_batch(out + kept, wanted, kept) < wanted)
+                    break;
+            }
+            return kept;
+        } else {
+            return step<T>::get_batch(out, n);
+        }
+    }
+
+    void push(sink<T> &out) override {
+        // get_batch reads a source in memory directly
+        if(branchless_select<T>::value && next_step->contiguous()) {
+            step<T>::push(out);
+            return;
+        }
+
+        filter_sink s(pred, out);
+        next_step->push(s);
+    }
+
+    size_hint hint() const override { return next_step->hint().loosened(); }
 private:
+    // selects from up to wanted elements of next_step into out, adding the number kept
+    // to kept, and returns how many were looked at. elements lying in memory are
+    // selected from there rather than being copied out first.
+    std::size_t select_batch(T *out, std::size_t wanted, std::size_t &kept) {
+        if constexpr(branchless_select<T>::value) {
+            if(const T *from = next_step->contiguous()) {
+                std::size_t count = std::min(wanted, next_step->hint().size);
+                kept += select_into(pred, from, out, count);
+                next_step->discard(count);
+                return count;
+            }
+        }
+
+        std::size_t count = next_step->get_batch(out, wanted);
+        kept += select_into(pred, out, out, count);
+        return count;
+    }
+
+    class filter_sink : public sink<T> {
+    public:
+        filter_sink(UnaryPred &p, sink<T> &o) : pred(p), out(o) {}
+
+        bool on_next(T &&value) override {
+            return !pred(value) || out.on_next(std::move(value));
+        }
+
+        bool on_batch(T *values, std::size_t n) override {
+            if constexpr(batchable<T>::value) {
+                std::size_t kept = select_into(pred, values, values, n);
+                return kept == 0 || out.on_batch(values, kept);
+            } else {
+                return sink<T>::on_batch(values, n);
+            }
+        }
+
+        std::size_t demand() const override { return out.demand(); }
+        void on_done() override { out.on_done(); }
+
+    private:
+        UnaryPred &pred;
+        sink<T> &out;
+    };
+
     UnaryPred pred;
     std::unique_ptr<step<T> > next_step;
 };
 
 
 
+template<typename Src, typename UnaryPred>
+class fused_filter {
+public:
+    using value_type = typename Src::value_type;
+
+    fused_filter(Src &&s, UnaryPred &&p) : src(std::move(s)), pred(std::move(p)) {}
+
+    std::optional<value_type> get() {
+        while(auto value = src.get()) {
+            if(pred(*value))
+                return value;
+        }
+        return {};
+    }
+private:
+    Src src;
+    UnaryPred pred;
+};
+
+
 template<typename UnaryPred>
 class first_if_t : public step_wrapper<first_if_t<UnaryPred> > {
 public:
@@ -62,6 +185,7 @@ public:
 
     template<typename T>
     std::optional<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &) {
+        s->limit(1);
         return s->get();
     }
 };
@@ -150,6 +274,14 @@ public:
         if(unbounded)
             throw unbounded_stream("cannot use last on an unbounded stream");
 
+        size_hint hint = s->hint();
+        if(hint.is_exact()) {
+            if(hint.size == 0)
+                return {};
+            s->discard(hint.size - 1);
+            return s->get();
+        }
+
         std::optional<T> last;
         while(std::optional<T> next = s->get()) {
             last = std::move(next);
@@ -175,6 +307,11 @@ public:
         return std::move(st);
     }
 
+    template<typename Src>
+    auto fuse(Src src, bool &) {
+        return detail::fused_filter<Src, UnaryPred>(std::move(src), std::move(pred));
+    }
+
 private:
     UnaryPred pred;
 };
@@ -2,6 +2,7 @@
 #define STREAMER_BASE_STEPS_HPP
 
 #include "base.hpp"
+#include <vector>
 
 
 namespace streamer {
@@ -22,9 +23,66 @@ public:
         else
             return {};
     }
+
+    std::size_t get_batch(U *out, std::size_t n) override {
+        if constexpr(batchable<T>::value && batchable<U>::value) {
+            if(buffer.size() < n)
+                buffer.resize(n);
+
+            std::size_t count = next_step->get_batch(buffer.data(), n);
+            for(std::size_t i = 0; i < count; i++)
+                out[i] = func(std::move(buffer[i]));
+            return count;
+        } else {
+            return step<U>::get_batch(out, n);
+        }
+    }
+
+    void push(sink<U> &out) override {
+        mapping_sink s(func, out);
+        next_step->push(s);
+    }
+
+    // the dropped elements are never passed to func
+    std::size_t discard(std::size_t n) override { return next_step->discard(n); }
+
+    size_hint hint() const override { return next_step->hint(); }
+
+    void limit(std::size_t n) override { next_step->limit(n); }
 private:
+    class mapping_sink : public sink<T> {
+    public:
+        mapping_sink(MemOrFunc &f, sink<U> &o) : func(f), out(o), buffer() {}
+
+        bool on_next(T &&value) override {
+            return out.on_next(U(func(std::move(value))));
+        }
+
+        bool on_batch(T *values, std::size_t n) override {
+            if constexpr(batchable<U>::value) {
+                if(buffer.size() < n)
+                    buffer.resize(n);
+
+                for(std::size_t i = 0; i < n; i++)
+                    buffer[i] = func(std::move(values[i]));
+                return out.on_batch(buffer.data(), n);
+            } else {
+                return sink<T>::on_batch(values, n);
+            }
+        }
+
+        std::size_t demand() const override { return out.demand(); }
+        void on_done() override { out.on_done(); }
+
+    private:
+        MemOrFunc &func;
+        sink<U> &out;
+        std::vector<U> buffer;
+    };
+
     MemOrFunc func;
     std::unique_ptr<step<T> > next_step;
+    std::vector<T> buffer;
 };
 
 
@@ -46,7 +104,47 @@ public:
         return {value};
     }
 
+    void push(sink<U> &out) override {
+        // elements left over from a previous get() go first
+        while(state && state->it != state->end) {
+            U value = *state->it;
+            state->it++;
+            if(!out.on_next(std::move(value))) {
+                out.on_done();
+                return;
+            }
+        }
+        state.reset();
+
+        flat_mapping_sink s(func, out);
+        next_step->push(s);
+    }
+
 private:
+    class flat_mapping_sink : public sink<T> {
+    public:
+        flat_mapping_sink(MemOrFunc &f, sink<U> &o) : func(f), out(o) {}
+
+        bool on_next(T &&value) override {
+            Cont cont = func(std::move(value));
+            for(auto it = std::begin(cont), end = std::end(cont); it != end; ++it) {
+                U elem = *it;
+                if(!out.on_next(std::move(elem)))
+                    return false;
+            }
+            return true;
+        }
+
+        // each element can expand into any number of elements
+        std::size_t demand() const override { return 1; }
+        void on_done() override { out.on_done(); }
+
+    private:
+        MemOrFunc &func;
+        sink<U> &out;
+    };
+
+
     struct state_t {
         state_t(Cont &&c) : cont(std::move(c)), it(std::begin(cont)), end(std::end(cont)) {}
 
@@ -74,6 +172,119 @@ private:
 };
 
 
+template<typename Src, typename MemOrFunc, typename U>
+class fused_mapping {
+public:
+    using value_type = U;
+
+    fused_mapping(Src &&s, MemOrFunc &&f) : src(std::move(s)), func(std::move(f)) {}
+
+    std::optional<U> get() {
+        if(auto value = src.get())
+            return {func(*std::move(value))};
+        else
+            return {};
+    }
+private:
+    Src src;
+    MemOrFunc func;
+};
+
+
+template<typename Src, typename MemOrFunc, typename Cont, typename U>
+class fused_flat_mapping {
+public:
+    using value_type = U;
+
+    fused_flat_mapping(Src &&s, MemOrFunc &&f) : src(std::move(s)), func(std::move(f)), state() {}
+
+    fused_flat_mapping(fused_flat_mapping &&other) 
+        : src(std::move(other.src)), func(std::move(other.func)), state() {}
+
+    std::optional<U> get() {
+        while(!state || state->it == state->end) {
+            auto value = src.get();
+            if(!value)
+                return {};
+            state.emplace(func(*std::move(value)));
+        }
+
+        U value = *state->it;
+        state->it++;
+        return {value};
+    }
+private:
+    struct state_t {
+        state_t(Cont &&c) : cont(std::move(c)), it(std::begin(cont)), end(std::end(cont)) {}
+
+        state_t(const state_t &) = delete;
+        state_t(state_t &&) = delete;
+        state_t &operator=(const state_t &) = delete;
+        state_t &operator=(state_t &&) = delete;
+
+        Cont cont;
+        typename std::remove_reference<decltype(std::begin(cont))>::type it;
+        typename std::remove_reference<decltype(std::begin(cont))>::type end;
+    };
+
+    Src src;
+    MemOrFunc func;
+    std::optional<state_t> state;
+};
+
+
+template<typename UnaryPred, typename T>
+class count_if_collector : public collector_sink<count_if_collector<UnaryPred, T>, T> {
+public:
+    count_if_collector(UnaryPred &&p) : pred(std::move(p)), i(0) {}
+
+    bool on_next(T &&value) override {
+        if(pred(std::move(value)))
+            i++;
+        return true;
+    }
+
+    std::size_t result() const noexcept { return i; }
+
+private:
+    UnaryPred pred;
+    std::size_t i;
+};
+
+
+template<typename T>
+class count_collector : public sink<T> {
+public:
+    count_collector() : i(0) {}
+
+    bool on_next(T &&) override { i++; return true; }
+    bool on_batch(T *, std::size_t n) override { i += n; return true; }
+
+    std::size_t result() const noexcept { return i; }
+
+private:
+    std::size_t i;
+};
+
+
+template<typename UnaryFunc, typename T>
+class each_collector : public collector_sink<each_collector<UnaryFunc, T>, T> {
+public:
+    each_collector(UnaryFunc &&f) : func(std::move(f)) {}
+
+    bool on_next(T &&value) override {
+        func(std::move(value));
+        return true;
+    }
+
+    void result() const noexcept {}
+
+private:
+    UnaryFunc func;
+};
+
+
+
 template<typename UnaryPred>
 class count_if_t : public step_wrapper<count_if_t<UnaryPred> > {
 public:
@@ -84,14 +295,14 @@ public:
         if(unbounded)
             throw unbounded_stream("cannot use item_count(UnaryPred) on an unbounded stream");
 
-        std::size_t i;
-
-        for(i = 0; std::optional<T> value = s->get(); ) {
-            if(pred(*std::move(value)))
-                i++;
-        }
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
+    }
 
-        return i;
+    template<typename T>
+    count_if_collector<UnaryPred, T> collector() {
+        return count_if_collector<UnaryPred, T>(std::move(pred));
     }
 
 private:
@@ -111,10 +322,17 @@ public:
         if(unbounded)
             throw unbounded_stream("cannot use item_count on an unbounded stream");
 
-        std::size_t i;
-        for(i = 0; s->get(); i++) {}
-        return i;
+        size_hint hint = s->hint();
+        if(hint.is_exact())
+            return hint.size;
+
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
     }
+
+    template<typename T>
+    count_collector<T> collector() { return count_collector<T>(); }
 };
 
 
@@ -128,7 +346,7 @@ public:
 
     template<typename T>
     auto stream(streamer_t<T> &, std::unique_ptr<detail::step<T> > &s, bool &unbounded) {
-        auto f = detail::member_mapper(std::move(func));
+        auto f = detail::stream_mapper<T>(std::move(func));
         using U = typename detail::remove_ref_cv<decltype(f(*std::move(s->get())))>::type;
 
         auto ptr = new detail::mapping_step<decltype(f), T, U>(std::move(f), std::move(s)); 
@@ -136,6 +354,13 @@ public:
         return streamer_t<U>(std::move(step), unbounded);
     }
 
+    template<typename Src>
+    auto fuse(Src src, bool &) {
+        auto f = detail::stream_mapper<typename Src::value_type>(std::move(func));
+        using U = typename detail::remove_ref_cv<decltype(f(std::declval<typename Src::value_type>()))>::type;
+        return detail::fused_mapping<Src, decltype(f), U>(std::move(src), std::move(f));
+    }
+
 private:
     MemOrFunc func;
 };
@@ -157,6 +382,14 @@ public:
         return streamer_t<U>(std::move(step), unbounded);
     }
 
+    template<typename Src>
+    auto fuse(Src src, bool &) {
+        auto f = detail::member_mapper(std::move(func));
+        using Cont = typename detail::remove_ref_cv<decltype(f(std::declval<typename Src::value_type>()))>::type;
+        using U = typename detail::remove_ref_cv<decltype(front(std::declval<Cont>()))>::type;
+        return detail::fused_flat_mapping<Src, decltype(f), Cont, U>(std::move(src), std::move(f));
+    }
+
 private:
     template<typename Cont>
     static auto front(Cont cont) { return *std::begin(cont); }
@@ -165,6 +398,34 @@ private:
 };
 
 
+namespace detail {
+
+
+class copied_t : public step_wrapper<copied_t> {
+public:
+    constexpr copied_t &operator()() noexcept { return *this; }
+
+    template<typename T>
+    auto stream(streamer_t<borrowed<T> > &st, std::unique_ptr<step<borrowed<T> > > &s, bool &unbounded) {
+        return mapping(copy()).stream(st, s, unbounded);
+    }
+
+    template<typename Src>
+    auto fuse(Src src, bool &unbounded) {
+        return mapping(copy()).fuse(std::move(src), unbounded);
+    }
+
+private:
+    struct copy {
+        template<typename T>
+        T operator()(borrowed<T> ref) const { return ref.get(); }
+    };
+};
+
+
+} // namespace detail
+
+
 template<typename UnaryFunc>
 class each : public detail::step_wrapper<each<UnaryFunc> > {
 public:
@@ -172,8 +433,13 @@ public:
 
     template<typename T>
     void stream(streamer_t<T> &, std::unique_ptr<detail::step<T> > &s, bool &) {
-        while(std::optional<T> value = s->get())
-            func(*std::move(value));
+        auto out = collector<T>();
+        s->push(out);
+    }
+
+    template<typename T>
+    detail::each_collector<UnaryFunc, T> collector() {
+        return detail::each_collector<UnaryFunc, T>(std::move(func));
     }
 
 private:
@@ -182,11 +448,13 @@ private:
 
 
 static detail::count_t item_count;
+static detail::copied_t copied;
 
 
 namespace detail {
     inline void steps_unused_warnings() {
         item_count();
+        copied();
     }
 } // namespace detail
 
@@ -11,17 +11,37 @@ namespace streamer {
 namespace detail {
 
     
+template<typename T>
+class deque_collector : public collector_sink<deque_collector<T>, T> {
+public:
+    bool on_next(T &&value) override {
+        out.push_back(std::move(value));
+        return true;
+    }
+
+    std::deque<T> result() { return std::move(out); }
+
+private:
+    std::deque<T> out;
+};
+
+
 class as_deque_t : public step_wrapper<as_deque_t> {
 public:
     constexpr as_deque_t &operator()() noexcept { return *this; }
 
     template<typename T>
-    std::deque<T> stream(streamer_t<T> &st, std::unique_ptr<step<T> > &, bool &unbounded) {
+    std::deque<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
         if(unbounded)
             throw unbounded_stream("cannot use as_deque on an unbounded stream");
 
-        return std::deque<T>(st.begin(), st.end());
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
     }
+
+    template<typename T>
+    deque_collector<T> collector() { return deque_collector<T>(); }
 };
 
 
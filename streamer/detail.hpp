@@ -1,13 +1,47 @@
 #ifndef STREAMER_DETAIL_HPP
 #define STREAMER_DETAIL_HPP
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <iterator>
 #include <functional>
 #include <optional>
+#include <stdexcept>
 #include <type_traits>
+#include <vector>
 
 
 namespace streamer {
+
+
+// a default-constructible std::reference_wrapper<const T>, so that streams of 
+// references can still be pulled in batches
+template<typename T>
+class borrowed {
+public:
+    constexpr borrowed() noexcept : ptr(nullptr) {}
+    constexpr borrowed(const T &ref) noexcept : ptr(&ref) {}
+    borrowed(const T &&) = delete;
+
+    constexpr const T &get() const noexcept { return *ptr; }
+    constexpr operator const T &() const noexcept { return *ptr; }
+    constexpr const T *operator->() const noexcept { return ptr; }
+
+private:
+    const T *ptr;
+};
+
+
+// tags the constructors of flat_map and flat_set which take an already sorted vector
+// without duplicate keys
+struct sorted_unique_t {
+    explicit sorted_unique_t() = default;
+};
+
+static constexpr sorted_unique_t sorted_unique{};
+
+
 namespace detail {
 
 
@@ -26,6 +60,113 @@ protected:
 };
 
 
+// keeps per-thread data on separate cache lines
+constexpr std::size_t cache_line = 64;
+
+template<typename T>
+struct alignas(cache_line) padded {
+    T value;
+};
+
+
+// number of elements terminals request at a time from step<T>::get_batch
+constexpr std::size_t batch_size = 256;
+
+
+// get_batch needs T to be default constructible and move assignable, since it
+// fills a caller-supplied buffer of already-constructed elements
+template<typename T>
+struct batchable : std::integral_constant<bool, 
+    std::is_default_constructible<T>::value && std::is_move_assignable<T>::value> {};
+
+
+// how many elements a step has left to give, as far as it can tell without pulling them
+class size_hint {
+public:
+    enum kind_t { unknown, upper_bound, exact };
+
+    constexpr size_hint() noexcept : kind(unknown), size(0) {}
+    constexpr size_hint(kind_t k, std::size_t n) noexcept : kind(k), size(n) {}
+
+    constexpr bool is_exact() const noexcept { return kind == exact; }
+    constexpr bool is_bounded() const noexcept { return kind != unknown; }
+
+    // at most n of the elements remain
+    constexpr size_hint capped(std::size_t n) const noexcept {
+        if(kind == unknown)
+            return {upper_bound, n};
+        return {kind, std::min(size, n)};
+    }
+
+    // the first n elements are dropped
+    constexpr size_hint skipped(std::size_t n) const noexcept {
+        return {kind, size > n ? size - n : 0};
+    }
+
+    // some of the elements may be dropped
+    constexpr size_hint loosened() const noexcept {
+        return {kind == exact ? upper_bound : kind, size};
+    }
+
+    kind_t kind;
+    std::size_t size;
+};
+
+
+template<typename It>
+struct is_random_access : std::is_base_of<std::random_access_iterator_tag, 
+    typename std::iterator_traits<It>::iterator_category> {};
+
+
+template<typename T>
+class sink {
+public:
+    constexpr sink() noexcept = default;
+
+    // returns false once the sink does not want any more elements
+    virtual bool on_next(T &&value) = 0;
+
+    // on_next for each of the n elements, stopping early if one returns false
+    virtual bool on_batch(T *values, std::size_t n) {
+        for(std::size_t i = 0; i < n; i++) {
+            if(!on_next(std::move(values[i])))
+                return false;
+        }
+        return true;
+    }
+
+    // the most elements the sink can accept before it might stop. 
+    // sources never push more than this in a single on_batch call.
+    virtual std::size_t demand() const { return batch_size; }
+
+    // called exactly once after the last element has been pushed
+    virtual void on_done() {}
+
+    virtual ~sink() {}
+
+protected:
+    sink(const sink<T> &) = default;
+    sink(sink<T> &&) = default;
+    sink<T> &operator=(const sink<T> &) = default;
+    sink<T> &operator=(sink<T> &&) = default;
+};
+
+
+// base for terminal sinks. on_batch calls Derived::on_next without virtual dispatch.
+template<typename Derived, typename T>
+class collector_sink : public sink<T> {
+public:
+    bool on_batch(T *values, std::size_t n) override {
+        Derived &self = static_cast<Derived&>(*this);
+        for(std::size_t i = 0; i < n; i++) {
+            if(!self.Derived::on_next(std::move(values[i])))
+                return false;
+        }
+        return true;
+    }
+};
+
+
 template<typename T>
 class step {
 public:
@@ -37,6 +178,68 @@ public:
     step<T> &operator=(step<T> &&) = delete;
 
     virtual std::optional<T> get() = 0;
+
+    // moves up to n elements into out and returns how many were written.
+    // fewer than n are written only if the stream is exhausted.
+    virtual std::size_t get_batch(T *out, std::size_t n) {
+        std::size_t i = 0;
+        if constexpr(batchable<T>::value) {
+            for(; i < n; i++) {
+                std::optional<T> value = get();
+                if(!value)
+                    break;
+                out[i] = *std::move(value);
+            }
+        }
+        return i;
+    }
+
+    // pushes the remaining elements into out until the stream is exhausted or out 
+    // returns false, then calls out.on_done()
+    virtual void push(sink<T> &out) {
+        if constexpr(batchable<T>::value) {
+            std::vector<T> buffer(batch_size);
+            std::size_t wanted;
+            std::size_t count;
+            do {
+                wanted = std::min(out.demand(), batch_size);
+                count = get_batch(buffer.data(), wanted);
+            } while(count > 0 && out.on_batch(buffer.data(), count) && count == wanted);
+        } else {
+            while(std::optional<T> value = get()) {
+                if(!out.on_next(*std::move(value)))
+                    break;
+            }
+        }
+        out.on_done();
+    }
+
+    // drops up to n elements without producing them and returns how many were
+    // dropped. fewer than n are dropped only if the stream is exhausted.
+    virtual std::size_t discard(std::size_t n) {
+        std::size_t i = 0;
+        for(; i < n && get(); i++) {}
+        return i;
+    }
+
+    virtual size_hint hint() const { return {}; }
+
+    // tells the step that no more than n of its elements will be taken or discarded,
+    // so that it can do less work. only called before anything is pulled from it.
+    virtual void limit(std::size_t) {}
+
+    // the remaining elements, if they lie one after another in memory, or null.
+    // hint().size of them can be read, without consuming anything.
+    virtual const T *contiguous() const { return nullptr; }
+
+    // true if at() can be used. an indexable step always has an exact hint().
+    virtual bool indexable() const { return false; }
+
+    // the i-th of the remaining elements, without consuming anything. may be called
+    // concurrently for different i, but at most once for each i, as it may move 
+    // the element out. only valid if indexable() is true.
+    virtual T at(std::size_t) { throw std::logic_error("step is not indexable"); }
+
     virtual ~step() {}
 };
 
@@ -49,6 +252,18 @@ struct remove_ref_cv {
 
 
 
+// whether the elements between two Its lie one after another in memory. only pointers
+// and std::vector and std::array iterators are known to.
+template<typename It, typename T>
+struct is_contiguous_iterator : std::integral_constant<bool,
+    std::is_same<It, T*>::value || std::is_same<It, const T*>::value ||
+    std::is_same<It, typename std::array<T, 1>::iterator>::value ||
+    std::is_same<It, typename std::array<T, 1>::const_iterator>::value ||
+    (!std::is_same<T, bool>::value && (
+        std::is_same<It, typename std::vector<T>::iterator>::value ||
+        std::is_same<It, typename std::vector<T>::const_iterator>::value))> {};
+
+
 template<typename Cont, typename T>
 class cont_source : public step<T> {
 public:
@@ -61,6 +276,52 @@ public:
         ++it;
         return {std::move(value)};
     }
+
+    std::size_t get_batch(T *out, std::size_t n) override {
+        if constexpr(batchable<T>::value) {
+            std::size_t i = 0;
+            for(; i < n && it != cont.end(); ++i, ++it)
+                out[i] = std::move(*it);
+            return i;
+        } else {
+            return step<T>::get_batch(out, n);
+        }
+    }
+
+    std::size_t discard(std::size_t n) override {
+        if constexpr(is_random_access<decltype(it)>::value) {
+            n = std::min(n, static_cast<std::size_t>(std::end(cont) - it));
+            it += n;
+            return n;
+        } else {
+            std::size_t i = 0;
+            for(; i < n && it != cont.end(); ++i, ++it) {}
+            return i;
+        }
+    }
+
+    size_hint hint() const override {
+        if constexpr(is_random_access<decltype(it)>::value)
+            return {size_hint::exact, static_cast<std::size_t>(std::end(cont) - it)};
+        else
+            return {};
+    }
+
+    bool indexable() const override { return is_random_access<decltype(it)>::value; }
+
+    T at(std::size_t i) override {
+        if constexpr(is_random_access<decltype(it)>::value)
+            return std::move(it[i]);
+        else
+            return step<T>::at(i);
+    }
+
+    const T *contiguous() const override {
+        if constexpr(is_contiguous_iterator<decltype(it), T>::value)
+            return it != std::end(cont) ? &*it : nullptr;
+        else
+            return nullptr;
+    }
 private:
     Cont cont;
     decltype(std::begin(cont)) it;
@@ -79,6 +340,52 @@ public:
         ++it;
         return {std::move(value)};
     }
+
+    std::size_t get_batch(T *out, std::size_t n) override {
+        if constexpr(batchable<T>::value) {
+            std::size_t i = 0;
+            for(; i < n && it != end; ++i, ++it)
+                out[i] = *it;
+            return i;
+        } else {
+            return step<T>::get_batch(out, n);
+        }
+    }
+
+    std::size_t discard(std::size_t n) override {
+        if constexpr(is_random_access<It>::value) {
+            n = std::min(n, static_cast<std::size_t>(end - it));
+            it += n;
+            return n;
+        } else {
+            std::size_t i = 0;
+            for(; i < n && it != end; ++i, ++it) {}
+            return i;
+        }
+    }
+
+    size_hint hint() const override {
+        if constexpr(is_random_access<It>::value)
+            return {size_hint::exact, static_cast<std::size_t>(end - it)};
+        else
+            return {};
+    }
+
+    bool indexable() const override { return is_random_access<It>::value; }
+
+    T at(std::size_t i) override {
+        if constexpr(is_random_access<It>::value)
+            return it[i];
+        else
+            return step<T>::at(i);
+    }
+
+    const T *contiguous() const override {
+        if constexpr(is_contiguous_iterator<It, T>::value)
+            return it != end ? &*it : nullptr;
+        else
+            return nullptr;
+    }
 private:
     It it;
     It end;
@@ -89,25 +396,84 @@ template<typename T>
 class empty_source : public step<T> {
 public:
     std::optional<T> get() override { return {}; }
+    size_hint hint() const override { return {size_hint::exact, 0}; }
 };
 
 
 template<typename UnaryFunc>
 auto member_mapper(UnaryFunc &&f) { return f; }
 
+// refers to the member of an lvalue, and moves the member out of an rvalue
+template<typename T, typename U>
+class member_var_mapper {
+public:
+    constexpr member_var_mapper(U T::*ptr) noexcept : p(ptr) {}
+
+    constexpr const U &operator()(const T &obj) const noexcept { return obj.*p; }
+    U operator()(T &&obj) const { return std::move(obj.*p); }
+
+private:
+    U T::*p;
+};
+
 template<typename T, typename U>
 constexpr auto member_mapper(U T::*p) noexcept {
-    return [p](const T &obj) { return obj.*p; };
+    return member_var_mapper<T, U>(p);
 }
 
+// getters returning a const U& are passed through as a reference
 template<typename T, typename U>
 constexpr auto member_mapper(U (T::*p)() const) noexcept {
-    return [p](const T &obj) { return (obj.*p)(); };
+    return [p](const T &obj) -> decltype(auto) { return (obj.*p)(); };
 }
 
 template<typename T, typename U>
 constexpr auto member_mapper(U (T::*p)() const noexcept) noexcept {
-    return [p](const T &obj) { return (obj.*p)(); };
+    return [p](const T &obj) -> decltype(auto) { return (obj.*p)(); };
+}
+
+
+template<typename T>
+struct is_borrowed : std::false_type {};
+
+template<typename T>
+struct is_borrowed<borrowed<T> > : std::true_type {};
+
+
+// like member_mapper, but pointers to member variables give a borrowed<U>
+// instead of a copy of the member
+template<typename UnaryFunc>
+auto member_ref_mapper(UnaryFunc &&f) { return member_mapper(std::forward<UnaryFunc>(f)); }
+
+template<typename T, typename U>
+constexpr auto member_ref_mapper(U T::*p) noexcept {
+    return [p](const T &obj) { return borrowed<U>(obj.*p); };
+}
+
+template<typename T, typename U>
+constexpr auto member_ref_mapper(U (T::*p)() const) noexcept { return member_mapper(p); }
+
+template<typename T, typename U>
+constexpr auto member_ref_mapper(U (T::*p)() const noexcept) noexcept { return member_mapper(p); }
+
+template<typename T, typename U>
+constexpr auto member_ref_mapper(const U &(T::*p)() const) noexcept {
+    return [p](const T &obj) { return borrowed<U>((obj.*p)()); };
+}
+
+template<typename T, typename U>
+constexpr auto member_ref_mapper(const U &(T::*p)() const noexcept) noexcept {
+    return [p](const T &obj) { return borrowed<U>((obj.*p)()); };
+}
+
+
+// the mapper used by mapping for a stream of T
+template<typename T, typename MemOrFunc>
+auto stream_mapper(MemOrFunc &&f) {
+    if constexpr(is_borrowed<T>::value)
+        return member_ref_mapper(std::forward<MemOrFunc>(f));
+    else
+        return member_mapper(std::forward<MemOrFunc>(f));
 }
 
 
@@ -126,10 +492,15 @@ auto member_comparer_custom(U (T::*p)() const noexcept, Comp &&comp) {
     return [p, comp](const T &left, const T &right) { return comp((left.*p)(), (right.*p)()); };
 }
 
-//template<typename T, typename U, typename Comp>
-//auto member_comparer_custom(const U& (T::*p)() const, Comp &&comp) {
-//    return [p, comp](const T &left, const T &right) { return comp((left.*p)(), (right.*p)()); };
-//}
+template<typename T, typename U, typename Comp>
+auto member_comparer_custom(const U& (T::*p)() const, Comp &&comp) {
+    return [p, comp](const T &left, const T &right) { return comp((left.*p)(), (right.*p)()); };
+}
+
+template<typename T, typename U, typename Comp>
+auto member_comparer_custom(const U& (T::*p)() const noexcept, Comp &&comp) {
+    return [p, comp](const T &left, const T &right) { return comp((left.*p)(), (right.*p)()); };
+}
 
 template<typename Comp>
 auto member_comparer(Comp &&comp) { return comp; }
@@ -143,8 +514,76 @@ auto member_comparer(U (T::*p)() const) { return member_comparer_custom(p, std::
 template<typename T, typename U>
 auto member_comparer(U (T::*p)() const noexcept) { return member_comparer_custom(p, std::less<U>()); }
 
-//template<typename T, typename U>
-//auto member_comparer(const U& (T::*p)() const) { return member_comparer_custom(p, std::less<U>()); }
+template<typename T, typename U>
+auto member_comparer(const U& (T::*p)() const) { return member_comparer_custom(p, std::less<U>()); }
+
+template<typename T, typename U>
+auto member_comparer(const U& (T::*p)() const noexcept) { return member_comparer_custom(p, std::less<U>()); }
+
+
+// stand-ins for std::hash<K>, std::equal_to<K>, std::less<K> and identity<T> in the
+// collectors which only learn the key type K and element type T once they are applied
+// to a stream
+struct default_hash {};
+struct default_equal_to {};
+struct default_less {};
+struct element_value {};
+
+template<typename K, typename Hash>
+auto hash_or_default(Hash &&h) {
+    if constexpr(std::is_same<typename remove_ref_cv<Hash>::type, default_hash>::value)
+        return std::hash<K>();
+    else
+        return std::forward<Hash>(h);
+}
+
+template<typename K, typename Eq>
+auto equal_to_or_default(Eq &&eq) {
+    if constexpr(std::is_same<typename remove_ref_cv<Eq>::type, default_equal_to>::value)
+        return std::equal_to<K>();
+    else
+        return std::forward<Eq>(eq);
+}
+
+template<typename K, typename Comp>
+auto less_or_default(Comp &&comp) {
+    if constexpr(std::is_same<typename remove_ref_cv<Comp>::type, default_less>::value)
+        return std::less<K>();
+    else
+        return std::forward<Comp>(comp);
+}
+
+
+// hashes and compares elements by the key KeyFunc returns for them
+template<typename KeyFunc, typename Hash>
+struct key_hasher {
+    template<typename T>
+    std::size_t operator()(const T &value) const {
+        using K = typename remove_ref_cv<decltype(key(value))>::type;
+        if constexpr(std::is_same<Hash, default_hash>::value)
+            return std::hash<K>()(key(value));
+        else
+            return hash(key(value));
+    }
+
+    KeyFunc key;
+    Hash hash;
+};
+
+template<typename KeyFunc, typename Eq>
+struct key_equal {
+    template<typename T>
+    bool operator()(const T &left, const T &right) const {
+        using K = typename remove_ref_cv<decltype(key(left))>::type;
+        if constexpr(std::is_same<Eq, default_equal_to>::value)
+            return std::equal_to<K>()(key(left), key(right));
+        else
+            return eq(key(left), key(right));
+    }
+
+    KeyFunc key;
+    Eq eq;
+};
 
   
 } // namespace detail
@@ -0,0 +1,140 @@
+#ifndef STREAMER_FEED_HPP
+#define STREAMER_FEED_HPP
+
+#include "base.hpp"
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+// the key feed inserts when given none
+struct whole_element {
+    template<typename T>
+    constexpr const T &operator()(const T &value) const noexcept { return value; }
+};
+
+
+// passes every element on unchanged after calling sketch.insert(key(element))
+template<typename Sketch, typename KeyFunc, typename T>
+class feed_step : public step<T> {
+public:
+    feed_step(Sketch &s, KeyFunc &&k, std::unique_ptr<step<T> > &&next)
+        : sketch(s), key(std::move(k)), next_step(std::move(next)) {}
+
+    std::optional<T> get() override {
+        std::optional<T> value = next_step->get();
+        if(value)
+            sketch.insert(key(*value));
+        return value;
+    }
+
+    std::size_t get_batch(T *out, std::size_t n) override {
+        if constexpr(batchable<T>::value) {
+            std::size_t count = next_step->get_batch(out, n);
+            for(std::size_t i = 0; i < count; i++)
+                sketch.insert(key(out[i]));
+            return count;
+        } else {
+            return step<T>::get_batch(out, n);
+        }
+    }
+
+    void push(sink<T> &out) override {
+        feed_sink s(sketch, key, out);
+        next_step->push(s);
+    }
+
+    // discard is left to step<T>, so that dropped elements are still inserted
+
+    size_hint hint() const override { return next_step->hint(); }
+
+    void limit(std::size_t n) override { next_step->limit(n); }
+
+private:
+    class feed_sink : public sink<T> {
+    public:
+        feed_sink(Sketch &s, KeyFunc &k, sink<T> &o) : sketch(s), key(k), out(o) {}
+
+        bool on_next(T &&value) override {
+            sketch.insert(key(value));
+            return out.on_next(std::move(value));
+        }
+
+        bool on_batch(T *values, std::size_t n) override {
+            for(std::size_t i = 0; i < n; i++)
+                sketch.insert(key(values[i]));
+            return out.on_batch(values, n);
+        }
+
+        std::size_t demand() const override { return out.demand(); }
+        void on_done() override { out.on_done(); }
+
+    private:
+        Sketch &sketch;
+        KeyFunc &key;
+        sink<T> &out;
+    };
+
+    Sketch &sketch;
+    KeyFunc key;
+    std::unique_ptr<step<T> > next_step;
+};
+
+
+template<typename Src, typename Sketch, typename KeyFunc>
+class fused_feed {
+public:
+    using value_type = typename Src::value_type;
+
+    fused_feed(Src &&s, Sketch &sk, KeyFunc &&k) : src(std::move(s)), sketch(&sk), key(std::move(k)) {}
+
+    std::optional<value_type> get() {
+        auto value = src.get();
+        if(value)
+            sketch->insert(key(*value));
+        return value;
+    }
+private:
+    Src src;
+    Sketch *sketch;
+    KeyFunc key;
+};
+
+
+} // namespace detail
+
+
+
+// inserts every element, or the key MemOrFunc returns for it, into sketch as it goes
+// past, such as a kll_sketch, which can be looked at while the stream is still running.
+// works on unbounded streams.
+template<typename Sketch, typename MemOrFunc = detail::whole_element>
+class feed : public detail::step_wrapper<feed<Sketch, MemOrFunc> > {
+public:
+    feed(Sketch &s, MemOrFunc k = MemOrFunc()) : sketch(s), key(std::move(k)) {}
+
+    template<typename T>
+    streamer_t<T> &&stream(streamer_t<T> &st, std::unique_ptr<detail::step<T> > &s, bool &) {
+        auto k = detail::member_mapper(std::move(key));
+        s.reset(new detail::feed_step<Sketch, decltype(k), T>(sketch, std::move(k), std::move(s)));
+        return std::move(st);
+    }
+
+    template<typename Src>
+    auto fuse(Src src, bool &) {
+        auto k = detail::member_mapper(std::move(key));
+        return detail::fused_feed<Src, Sketch, decltype(k)>(std::move(src), sketch, std::move(k));
+    }
+
+private:
+    Sketch &sketch;
+    MemOrFunc key;
+};
+
+
+} // namespace streamer
+
+#endif
@@ -0,0 +1,516 @@
+#ifndef STREAMER_FLAT_HASH_HPP
+#define STREAMER_FLAT_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+// spreads the bits of a hash, as std::hash is the identity for integers on common
+// implementations and the tables below use the low bits as an index
+constexpr std::uint64_t mix_hash(std::uint64_t x) noexcept {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+
+template<typename Value, bool Const>
+class flat_hash_iterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = typename std::conditional<Const, const Value*, Value*>::type;
+    using reference = typename std::conditional<Const, const Value&, Value&>::type;
+
+    flat_hash_iterator() noexcept : ctrl(nullptr), slots(nullptr), i(0), cap(0) {}
+
+    flat_hash_iterator(const std::uint8_t *c, pointer s, std::size_t index, std::size_t capacity) noexcept
+        : ctrl(c), slots(s), i(index), cap(capacity) {
+        skip_empty();
+    }
+
+    template<bool C = Const, typename = typename std::enable_if<C>::type>
+    flat_hash_iterator(const flat_hash_iterator<Value, false> &other) noexcept
+        : ctrl(other.ctrl), slots(other.slots), i(other.i), cap(other.cap) {}
+
+    reference operator*() const noexcept { return slots[i]; }
+    pointer operator->() const noexcept { return slots + i; }
+
+    flat_hash_iterator &operator++() noexcept {
+        ++i;
+        skip_empty();
+        return *this;
+    }
+
+    flat_hash_iterator operator++(int) noexcept {
+        flat_hash_iterator old = *this;
+        ++*this;
+        return old;
+    }
+
+    friend bool operator==(const flat_hash_iterator &a, const flat_hash_iterator &b) noexcept { return a.i == b.i; }
+    friend bool operator!=(const flat_hash_iterator &a, const flat_hash_iterator &b) noexcept { return a.i != b.i; }
+
+private:
+    friend class flat_hash_iterator<Value, !Const>;
+
+    void skip_empty() noexcept {
+        while(i < cap && ctrl[i] == 0)
+            ++i;
+    }
+
+    const std::uint8_t *ctrl;
+    pointer slots;
+    std::size_t i;
+    std::size_t cap;
+};
+
+
+// open addressing with linear probing over a power of two number of slots, kept at most
+// 7/8 full. ctrl[i] is 0 for an empty slot, or the top bits of the hash of the slot's key
+// with the high bit set, so that most mismatches are rejected without comparing keys.
+// there are no tombstones: erase moves the rest of the probe sequence back instead.
+template<typename Value, typename K, typename KeyOf, typename Hash, typename Eq>
+class flat_hash_table {
+public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    flat_hash_table(const Hash &h, const Eq &e) : hash(h), eq(e), ctrl(), slots(nullptr), cap(0), count(0) {}
+
+    flat_hash_table(const flat_hash_table &other)
+        : hash(other.hash), eq(other.eq), ctrl(), slots(nullptr), cap(0), count(0) {
+        if(other.count == 0)
+            return;
+
+        allocate(other.cap);
+        std::size_t i = 0;
+        try {
+            for(; i < cap; i++) {
+                if(other.ctrl[i]) {
+                    new (slots + i) Value(other.slots[i]);
+                    ctrl[i] = other.ctrl[i];
+                }
+            }
+        } catch(...) {
+            destroy();
+            throw;
+        }
+        count = other.count;
+    }
+
+    flat_hash_table(flat_hash_table &&other) noexcept
+        : hash(std::move(other.hash)),
+          eq(std::move(other.eq)),
+          ctrl(std::move(other.ctrl)),
+          slots(std::exchange(other.slots, nullptr)),
+          cap(std::exchange(other.cap, 0)),
+          count(std::exchange(other.count, 0)) {}
+
+    flat_hash_table &operator=(flat_hash_table other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    ~flat_hash_table() { destroy(); }
+
+    void swap(flat_hash_table &other) noexcept {
+        using std::swap;
+        swap(hash, other.hash);
+        swap(eq, other.eq);
+        swap(ctrl, other.ctrl);
+        swap(slots, other.slots);
+        swap(cap, other.cap);
+        swap(count, other.count);
+    }
+
+    std::size_t size() const noexcept { return count; }
+    std::size_t capacity() const noexcept { return cap; }
+
+    const Hash &hash_function() const noexcept { return hash; }
+    const Eq &key_eq() const noexcept { return eq; }
+
+    const std::uint8_t *ctrl_data() const noexcept { return ctrl.get(); }
+    Value *slot_data() noexcept { return slots; }
+    const Value *slot_data() const noexcept { return slots; }
+
+    void reserve(std::size_t n) {
+        std::size_t needed = slots_for(n);
+        if(needed > cap)
+            rehash(needed);
+    }
+
+    void clear() noexcept {
+        for(std::size_t i = 0; i < cap; i++) {
+            if(ctrl[i]) {
+                slots[i].~Value();
+                ctrl[i] = 0;
+            }
+        }
+        count = 0;
+    }
+
+    // the slot holding key, or npos
+    std::size_t find(const K &key) const {
+        if(count == 0)
+            return npos;
+
+        std::uint64_t h = mix_hash(hash(key));
+        std::uint8_t tag = tag_of(h);
+        for(std::size_t i = h & (cap - 1);; i = (i + 1) & (cap - 1)) {
+            if(ctrl[i] == 0)
+                return npos;
+            if(ctrl[i] == tag && eq(KeyOf::get(slots[i]), key))
+                return i;
+        }
+    }
+
+    // the slot holding key, and false. if there is none, the Value returned by make()
+    // is put in a new slot, and true is returned with it. make is called only then, so
+    // it may move from whatever key refers to.
+    template<typename Make>
+    std::pair<std::size_t, bool> insert_with(const K &key, Make &&make) {
+        std::uint64_t h = mix_hash(hash(key));
+        std::uint8_t tag = tag_of(h);
+
+        if(count > 0) {
+            for(std::size_t i = h & (cap - 1);; i = (i + 1) & (cap - 1)) {
+                if(ctrl[i] == 0)
+                    break;
+                if(ctrl[i] == tag && eq(KeyOf::get(slots[i]), key))
+                    return {i, false};
+            }
+        }
+
+        if(count + 1 > max_load(cap))
+            rehash(slots_for(count + 1));
+
+        std::size_t i = empty_slot(h);
+        new (slots + i) Value(make());
+        ctrl[i] = tag;
+        ++count;
+        return {i, true};
+    }
+
+    void erase_at(std::size_t hole) noexcept {
+        slots[hole].~Value();
+        ctrl[hole] = 0;
+        --count;
+
+        // an element can fill the hole if the hole lies between its home slot and where it is
+        for(std::size_t i = (hole + 1) & (cap - 1); ctrl[i] != 0; i = (i + 1) & (cap - 1)) {
+            std::size_t home = mix_hash(hash(KeyOf::get(slots[i]))) & (cap - 1);
+            if(((i - home) & (cap - 1)) >= ((i - hole) & (cap - 1))) {
+                new (slots + hole) Value(std::move(slots[i]));
+                slots[i].~Value();
+                ctrl[hole] = ctrl[i];
+                ctrl[i] = 0;
+                hole = i;
+            }
+        }
+    }
+
+private:
+    static constexpr std::uint8_t tag_of(std::uint64_t h) noexcept {
+        return static_cast<std::uint8_t>(0x80 | (h >> 57));
+    }
+
+    static constexpr std::size_t max_load(std::size_t slot_count) noexcept {
+        return slot_count - slot_count / 8;
+    }
+
+    // the smallest power of two number of slots which holds n elements
+    static std::size_t slots_for(std::size_t n) noexcept {
+        if(n == 0)
+            return 0;
+        std::size_t c = 8;
+        while(max_load(c) < n)
+            c *= 2;
+        return c;
+    }
+
+    std::size_t empty_slot(std::uint64_t h) const noexcept {
+        std::size_t i = h & (cap - 1);
+        while(ctrl[i] != 0)
+            i = (i + 1) & (cap - 1);
+        return i;
+    }
+
+    void allocate(std::size_t slot_count) {
+        ctrl.reset(new std::uint8_t[slot_count]());
+        slots = std::allocator<Value>().allocate(slot_count);
+        cap = slot_count;
+    }
+
+    void rehash(std::size_t slot_count) {
+        std::unique_ptr<std::uint8_t[]> old_ctrl = std::move(ctrl);
+        Value *old_slots = slots;
+        std::size_t old_cap = cap;
+
+        allocate(slot_count);
+        for(std::size_t i = 0; i < old_cap; i++) {
+            if(old_ctrl[i]) {
+                std::size_t j = empty_slot(mix_hash(hash(KeyOf::get(old_slots[i]))));
+                new (slots + j) Value(std::move(old_slots[i]));
+                old_slots[i].~Value();
+                ctrl[j] = old_ctrl[i];
+            }
+        }
+
+        if(old_slots)
+            std::allocator<Value>().deallocate(old_slots, old_cap);
+    }
+
+    void destroy() noexcept {
+        if(!slots)
+            return;
+        clear();
+        std::allocator<Value>().deallocate(slots, cap);
+        slots = nullptr;
+        ctrl.reset();
+        cap = 0;
+    }
+
+    Hash hash;
+    Eq eq;
+    std::unique_ptr<std::uint8_t[]> ctrl;
+    Value *slots;
+    std::size_t cap;
+    std::size_t count;
+};
+
+
+template<typename K, typename V>
+struct pair_key {
+    static const K &get(const std::pair<K, V> &p) noexcept { return p.first; }
+};
+
+template<typename K>
+struct self_key {
+    static const K &get(const K &k) noexcept { return k; }
+};
+
+
+} // namespace detail
+
+
+
+// an unordered map storing its elements in one array, without a node per element.
+// iterators and references are invalidated by any insert or erase. the elements are
+// std::pair<K, V> rather than std::pair<const K, V>, so that they can be moved when
+// the table grows, and the key of an element must not be changed through an iterator.
+template<typename K, typename V, typename Hash = std::hash<K>, typename Eq = std::equal_to<K> >
+class flat_hash_map {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = Eq;
+    using iterator = detail::flat_hash_iterator<value_type, false>;
+    using const_iterator = detail::flat_hash_iterator<value_type, true>;
+
+    explicit flat_hash_map(size_type n = 0, const Hash &h = Hash(), const Eq &e = Eq()) : table(h, e) {
+        table.reserve(n);
+    }
+
+    iterator begin() noexcept { return at_index(0); }
+    iterator end() noexcept { return at_index(table.capacity()); }
+    const_iterator begin() const noexcept { return at_index(0); }
+    const_iterator end() const noexcept { return at_index(table.capacity()); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    bool empty() const noexcept { return table.size() == 0; }
+    size_type size() const noexcept { return table.size(); }
+    void reserve(size_type n) { table.reserve(n); }
+    void clear() noexcept { table.clear(); }
+
+    iterator find(const K &key) { return at_index(found(key)); }
+    const_iterator find(const K &key) const { return at_index(found(key)); }
+    size_type count(const K &key) const { return table.find(key) != table_t::npos; }
+    bool contains(const K &key) const { return table.find(key) != table_t::npos; }
+
+    V &at(const K &key) {
+        std::size_t i = table.find(key);
+        if(i == table_t::npos)
+            throw std::out_of_range("key not found in flat_hash_map");
+        return table.slot_data()[i].second;
+    }
+
+    const V &at(const K &key) const {
+        std::size_t i = table.find(key);
+        if(i == table_t::npos)
+            throw std::out_of_range("key not found in flat_hash_map");
+        return table.slot_data()[i].second;
+    }
+
+    V &operator[](const K &key) { return try_emplace(key).first->second; }
+    V &operator[](K &&key) { return try_emplace(std::move(key)).first->second; }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const K &key, Args &&...args) {
+        auto r = table.insert_with(key, [&]() {
+            return value_type(std::piecewise_construct,
+                std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        });
+        return {at_index(r.first), r.second};
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(K &&key, Args &&...args) {
+        auto r = table.insert_with(key, [&]() {
+            return value_type(std::piecewise_construct,
+                std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        });
+        return {at_index(r.first), r.second};
+    }
+
+    std::pair<iterator, bool> insert(const value_type &value) { return try_emplace(value.first, value.second); }
+    std::pair<iterator, bool> insert(value_type &&value) { return try_emplace(std::move(value.first), std::move(value.second)); }
+
+    size_type erase(const K &key) {
+        std::size_t i = table.find(key);
+        if(i == table_t::npos)
+            return 0;
+        table.erase_at(i);
+        return 1;
+    }
+
+    hasher hash_function() const { return table.hash_function(); }
+    key_equal key_eq() const { return table.key_eq(); }
+
+    friend bool operator==(const flat_hash_map &a, const flat_hash_map &b) {
+        if(a.size() != b.size())
+            return false;
+        for(const value_type &p : a) {
+            auto it = b.find(p.first);
+            if(it == b.end() || !(it->second == p.second))
+                return false;
+        }
+        return true;
+    }
+
+    friend bool operator!=(const flat_hash_map &a, const flat_hash_map &b) { return !(a == b); }
+
+private:
+    using table_t = detail::flat_hash_table<value_type, K, detail::pair_key<K, V>, Hash, Eq>;
+
+    std::size_t found(const K &key) const {
+        std::size_t i = table.find(key);
+        return i == table_t::npos ? table.capacity() : i;
+    }
+
+    iterator at_index(std::size_t i) noexcept {
+        return iterator(table.ctrl_data(), table.slot_data(), i, table.capacity());
+    }
+
+    const_iterator at_index(std::size_t i) const noexcept {
+        return const_iterator(table.ctrl_data(), table.slot_data(), i, table.capacity());
+    }
+
+    table_t table;
+};
+
+
+
+// an unordered set storing its elements in one array, without a node per element.
+// iterators and references are invalidated by any insert or erase.
+template<typename K, typename Hash = std::hash<K>, typename Eq = std::equal_to<K> >
+class flat_hash_set {
+public:
+    using key_type = K;
+    using value_type = K;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using key_equal = Eq;
+    using iterator = detail::flat_hash_iterator<K, true>;
+    using const_iterator = iterator;
+
+    explicit flat_hash_set(size_type n = 0, const Hash &h = Hash(), const Eq &e = Eq()) : table(h, e) {
+        table.reserve(n);
+    }
+
+    iterator begin() const noexcept { return at_index(0); }
+    iterator end() const noexcept { return at_index(table.capacity()); }
+    iterator cbegin() const noexcept { return begin(); }
+    iterator cend() const noexcept { return end(); }
+
+    bool empty() const noexcept { return table.size() == 0; }
+    size_type size() const noexcept { return table.size(); }
+    void reserve(size_type n) { table.reserve(n); }
+    void clear() noexcept { table.clear(); }
+
+    iterator find(const K &key) const {
+        std::size_t i = table.find(key);
+        return at_index(i == table_t::npos ? table.capacity() : i);
+    }
+
+    size_type count(const K &key) const { return table.find(key) != table_t::npos; }
+    bool contains(const K &key) const { return table.find(key) != table_t::npos; }
+
+    std::pair<iterator, bool> insert(const K &key) {
+        auto r = table.insert_with(key, [&]() { return K(key); });
+        return {at_index(r.first), r.second};
+    }
+
+    std::pair<iterator, bool> insert(K &&key) {
+        auto r = table.insert_with(key, [&]() { return K(std::move(key)); });
+        return {at_index(r.first), r.second};
+    }
+
+    size_type erase(const K &key) {
+        std::size_t i = table.find(key);
+        if(i == table_t::npos)
+            return 0;
+        table.erase_at(i);
+        return 1;
+    }
+
+    hasher hash_function() const { return table.hash_function(); }
+    key_equal key_eq() const { return table.key_eq(); }
+
+    friend bool operator==(const flat_hash_set &a, const flat_hash_set &b) {
+        if(a.size() != b.size())
+            return false;
+        for(const K &k : a) {
+            if(!b.contains(k))
+                return false;
+        }
+        return true;
+    }
+
+    friend bool operator!=(const flat_hash_set &a, const flat_hash_set &b) { return !(a == b); }
+
+private:
+    using table_t = detail::flat_hash_table<K, K, detail::self_key<K>, Hash, Eq>;
+
+    iterator at_index(std::size_t i) const noexcept {
+        return iterator(table.ctrl_data(), table.slot_data(), i, table.capacity());
+    }
+
+    table_t table;
+};
+
+
+} // namespace streamer
+
+#endif
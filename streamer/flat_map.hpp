@@ -0,0 +1,275 @@
+#ifndef STREAMER_FLAT_MAP_HPP
+#define STREAMER_FLAT_MAP_HPP
+
+#include "base.hpp"
+#include "map.hpp"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+namespace streamer {
+
+
+// a map kept as a vector of key/value pairs sorted by key, looked up by binary search.
+// inserting or erasing moves every element after it, so it suits maps which are built
+// once and then mostly read. the key of an element must not be changed through an
+// iterator, as that would break the order.
+template<typename K, typename V, typename Comp = std::less<K> >
+class flat_map {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using size_type = std::size_t;
+    using key_compare = Comp;
+    using container_type = std::vector<value_type>;
+    using iterator = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+
+    explicit flat_map(const Comp &c = Comp()) : comp(c), elements() {}
+
+    // elements must be sorted by Comp, with no two equal keys
+    flat_map(sorted_unique_t, container_type &&sorted, const Comp &c = Comp())
+        : comp(c), elements(std::move(sorted)) {}
+
+    iterator begin() noexcept { return elements.begin(); }
+    iterator end() noexcept { return elements.end(); }
+    const_iterator begin() const noexcept { return elements.begin(); }
+    const_iterator end() const noexcept { return elements.end(); }
+    const_iterator cbegin() const noexcept { return elements.cbegin(); }
+    const_iterator cend() const noexcept { return elements.cend(); }
+
+    bool empty() const noexcept { return elements.empty(); }
+    size_type size() const noexcept { return elements.size(); }
+    void reserve(size_type n) { elements.reserve(n); }
+    void clear() noexcept { elements.clear(); }
+
+    const container_type &values() const noexcept { return elements; }
+    key_compare key_comp() const { return comp; }
+
+    iterator lower_bound(const K &key) {
+        return std::lower_bound(elements.begin(), elements.end(), key, key_less());
+    }
+
+    const_iterator lower_bound(const K &key) const {
+        return std::lower_bound(elements.begin(), elements.end(), key, key_less());
+    }
+
+    iterator upper_bound(const K &key) {
+        return std::upper_bound(elements.begin(), elements.end(), key, key_greater());
+    }
+
+    const_iterator upper_bound(const K &key) const {
+        return std::upper_bound(elements.begin(), elements.end(), key, key_greater());
+    }
+
+    iterator find(const K &key) {
+        auto it = lower_bound(key);
+        return it != end() && !comp(key, it->first) ? it : end();
+    }
+
+    const_iterator find(const K &key) const {
+        auto it = lower_bound(key);
+        return it != end() && !comp(key, it->first) ? it : end();
+    }
+
+    size_type count(const K &key) const { return find(key) != end(); }
+    bool contains(const K &key) const { return find(key) != end(); }
+
+    V &at(const K &key) {
+        auto it = find(key);
+        if(it == end())
+            throw std::out_of_range("key not found in flat_map");
+        return it->second;
+    }
+
+    const V &at(const K &key) const {
+        auto it = find(key);
+        if(it == end())
+            throw std::out_of_range("key not found in flat_map");
+        return it->second;
+    }
+
+    V &operator[](const K &key) { return try_emplace(key).first->second; }
+    V &operator[](K &&key) { return try_emplace(std::move(key)).first->second; }
+
+    template<typename Key, typename... Args>
+    std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args) {
+        auto it = lower_bound(key);
+        if(it != end() && !comp(key, it->first))
+            return {it, false};
+
+        it = elements.emplace(it, std::piecewise_construct,
+            std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        return {it, true};
+    }
+
+    std::pair<iterator, bool> insert(const value_type &value) { return try_emplace(value.first, value.second); }
+    std::pair<iterator, bool> insert(value_type &&value) { return try_emplace(std::move(value.first), std::move(value.second)); }
+
+    size_type erase(const K &key) {
+        auto it = find(key);
+        if(it == end())
+            return 0;
+        elements.erase(it);
+        return 1;
+    }
+
+    iterator erase(const_iterator it) { return elements.erase(it); }
+
+    friend bool operator==(const flat_map &a, const flat_map &b) { return a.elements == b.elements; }
+    friend bool operator!=(const flat_map &a, const flat_map &b) { return a.elements != b.elements; }
+
+private:
+    auto key_less() const {
+        return [this](const value_type &element, const K &key) { return comp(element.first, key); };
+    }
+
+    auto key_greater() const {
+        return [this](const K &key, const value_type &element) { return comp(key, element.first); };
+    }
+
+    Comp comp;
+    container_type elements;
+};
+
+
+
+namespace detail {
+
+
+template<typename KeyFunc, typename ValueFunc, typename Comp, typename T>
+class flat_map_collector : public collector_sink<flat_map_collector<KeyFunc, ValueFunc, Comp, T>, T> {
+public:
+    using K = typename remove_ref_cv<decltype(std::declval<KeyFunc&>()(std::declval<T&>()))>::type;
+    using V = typename remove_ref_cv<decltype(std::declval<ValueFunc&>()(std::declval<T>()))>::type;
+
+    flat_map_collector(KeyFunc &&keyFunc, ValueFunc &&valueFunc, Comp &&comp, bool throw_on_dup)
+        : k(std::move(keyFunc)), v(std::move(valueFunc)), c(std::move(comp)), out(), dup_throw(throw_on_dup) {}
+
+    bool on_next(T &&value) override {
+        // key may refer into value, so it has to be taken before value is moved
+        K key(k(value));
+        out.emplace_back(std::move(key), v(std::move(value)));
+        return true;
+    }
+
+    void reserve(size_hint hint) {
+        if(hint.is_exact())
+            out.reserve(out.size() + hint.size);
+    }
+
+    // sorted once everything has arrived. the sort is stable, so the first of several
+    // equal keys is the one kept.
+    flat_map<K, V, Comp> result() {
+        auto less = [this](const std::pair<K, V> &a, const std::pair<K, V> &b) { return c(a.first, b.first); };
+        std::stable_sort(out.begin(), out.end(), less);
+
+        auto same = [this](const std::pair<K, V> &a, const std::pair<K, V> &b) { return !c(a.first, b.first); };
+        auto dup = std::adjacent_find(out.begin(), out.end(), same);
+        if(dup != out.end()) {
+            if(dup_throw)
+                throw duplicate_map_key("key already exists in map");
+            out.erase(std::unique(dup, out.end(), same), out.end());
+        }
+
+        return flat_map<K, V, Comp>(sorted_unique, std::move(out), c);
+    }
+
+private:
+    KeyFunc k;
+    ValueFunc v;
+    Comp c;
+    std::vector<std::pair<K, V> > out;
+    bool dup_throw;
+};
+
+
+template<typename KeyFunc, typename ValueFunc, typename Comp>
+class as_flat_map_t : public step_wrapper<as_flat_map_t<KeyFunc, ValueFunc, Comp> > {
+public:
+    as_flat_map_t(KeyFunc &&keyFunc, ValueFunc &&valueFunc, Comp &&comp, bool throw_on_dup)
+        : k(std::move(keyFunc)), v(std::move(valueFunc)), c(std::move(comp)), dup_throw(throw_on_dup) {}
+
+    template<typename T>
+    auto stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use as_flat_map on an unbounded stream");
+
+        auto out = collector<T>();
+        out.reserve(s->hint());
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    auto collector() {
+        using K = typename remove_ref_cv<decltype(k(std::declval<T&>()))>::type;
+        auto comp = less_or_default<K>(std::move(c));
+
+        if constexpr(std::is_same<ValueFunc, element_value>::value) {
+            return flat_map_collector<KeyFunc, identity<T>, decltype(comp), T>(
+                std::move(k), identity<T>(), std::move(comp), dup_throw);
+        } else {
+            return flat_map_collector<KeyFunc, ValueFunc, decltype(comp), T>(
+                std::move(k), std::move(v), std::move(comp), dup_throw);
+        }
+    }
+
+private:
+    KeyFunc k;
+    ValueFunc v;
+    Comp c;
+    bool dup_throw;
+};
+
+
+template<typename KeyFunc, typename ValueFunc, typename Comp>
+auto as_flat_map_of(KeyFunc &&k, ValueFunc &&v, Comp &&c, bool throw_on_dup) {
+    return as_flat_map_t<KeyFunc, ValueFunc, Comp>(std::move(k), std::move(v), std::move(c), throw_on_dup);
+}
+
+
+}  // namespace detail
+
+
+
+template<typename KeyFunc, typename ValueFunc, typename Comp>
+auto as_flat_map(KeyFunc k, ValueFunc v, Comp c, bool throw_on_dup = true) {
+    return detail::as_flat_map_of(
+        detail::member_mapper(std::move(k)),
+        detail::member_mapper(std::move(v)),
+        std::move(c),
+        throw_on_dup
+    );
+}
+
+
+template<typename KeyFunc, typename ValueFunc>
+auto as_flat_map(KeyFunc k, ValueFunc v, bool throw_on_dup = true) {
+    return detail::as_flat_map_of(
+        detail::member_mapper(std::move(k)),
+        detail::member_mapper(std::move(v)),
+        detail::default_less(),
+        throw_on_dup
+    );
+}
+
+
+template<typename KeyFunc>
+auto as_flat_map(KeyFunc k, bool throw_on_dup = true) {
+    return detail::as_flat_map_of(
+        detail::member_mapper(std::move(k)),
+        detail::element_value(),
+        detail::default_less(),
+        throw_on_dup
+    );
+}
+
+
+} // namespace streamer
+
+#endif
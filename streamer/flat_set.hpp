@@ -0,0 +1,270 @@
+#ifndef STREAMER_FLAT_SET_HPP
+#define STREAMER_FLAT_SET_HPP
+
+#include "base.hpp"
+#include "set.hpp"
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+
+namespace streamer {
+
+
+// a set kept as a sorted vector, looked up by binary search. inserting or erasing moves
+// every element after it, so it suits sets which are built once and then mostly read.
+template<typename K, typename Comp = std::less<K> >
+class flat_set {
+public:
+    using key_type = K;
+    using value_type = K;
+    using size_type = std::size_t;
+    using key_compare = Comp;
+    using value_compare = Comp;
+    using container_type = std::vector<K>;
+    using iterator = typename container_type::const_iterator;
+    using const_iterator = iterator;
+
+    explicit flat_set(const Comp &c = Comp()) : comp(c), elements() {}
+
+    // elements must be sorted by Comp, with no two equal elements
+    flat_set(sorted_unique_t, container_type &&sorted, const Comp &c = Comp())
+        : comp(c), elements(std::move(sorted)) {}
+
+    iterator begin() const noexcept { return elements.begin(); }
+    iterator end() const noexcept { return elements.end(); }
+    iterator cbegin() const noexcept { return elements.cbegin(); }
+    iterator cend() const noexcept { return elements.cend(); }
+
+    bool empty() const noexcept { return elements.empty(); }
+    size_type size() const noexcept { return elements.size(); }
+    void reserve(size_type n) { elements.reserve(n); }
+    void clear() noexcept { elements.clear(); }
+
+    const container_type &values() const noexcept { return elements; }
+    key_compare key_comp() const { return comp; }
+
+    iterator lower_bound(const K &key) const { return std::lower_bound(elements.begin(), elements.end(), key, comp); }
+    iterator upper_bound(const K &key) const { return std::upper_bound(elements.begin(), elements.end(), key, comp); }
+
+    iterator find(const K &key) const {
+        auto it = lower_bound(key);
+        return it != end() && !comp(key, *it) ? it : end();
+    }
+
+    size_type count(const K &key) const { return find(key) != end(); }
+    bool contains(const K &key) const { return find(key) != end(); }
+
+    template<typename Key>
+    std::pair<iterator, bool> insert(Key &&key) {
+        auto it = lower_bound(key);
+        if(it != end() && !comp(key, *it))
+            return {it, false};
+        return {elements.insert(it, std::forward<Key>(key)), true};
+    }
+
+    size_type erase(const K &key) {
+        auto it = find(key);
+        if(it == end())
+            return 0;
+        elements.erase(it);
+        return 1;
+    }
+
+    iterator erase(iterator it) { return elements.erase(it); }
+
+    friend bool operator==(const flat_set &a, const flat_set &b) { return a.elements == b.elements; }
+    friend bool operator!=(const flat_set &a, const flat_set &b) { return a.elements != b.elements; }
+
+private:
+    Comp comp;
+    container_type elements;
+};
+
+
+
+namespace detail {
+
+
+// collects the elements, then sorts them once they have all arrived. the sort is stable,
+// so equal elements stay in stream order.
+template<typename Comp, typename T>
+class sorting_collector : public sink<T> {
+public:
+    sorting_collector(Comp &&c) : comp(std::move(c)), out() {}
+
+    bool on_next(T &&value) override {
+        out.push_back(std::move(value));
+        return true;
+    }
+
+    bool on_batch(T *values, std::size_t n) override {
+        out.insert(out.end(), std::make_move_iterator(values), std::make_move_iterator(values + n));
+        return true;
+    }
+
+    void reserve(size_hint hint) {
+        if(hint.is_exact())
+            out.reserve(out.size() + hint.size);
+    }
+
+    std::vector<T> result() {
+        std::stable_sort(out.begin(), out.end(), comp);
+        return std::move(out);
+    }
+
+protected:
+    Comp comp;
+    std::vector<T> out;
+};
+
+
+template<typename Comp, typename T>
+class flat_set_collector : public sorting_collector<Comp, T> {
+public:
+    flat_set_collector(Comp &&c, bool throw_on_dup) : sorting_collector<Comp, T>(std::move(c)), dup_throw(throw_on_dup) {}
+
+    // the first of several equal elements is the one kept
+    flat_set<T, Comp> result() {
+        std::vector<T> sorted = sorting_collector<Comp, T>::result();
+        Comp &comp = this->comp;
+
+        auto same = [&comp](const T &a, const T &b) { return !comp(a, b); };
+        auto dup = std::adjacent_find(sorted.begin(), sorted.end(), same);
+        if(dup != sorted.end()) {
+            if(dup_throw)
+                throw duplicate_set_key("value already exists in set");
+            sorted.erase(std::unique(dup, sorted.end(), same), sorted.end());
+        }
+
+        return flat_set<T, Comp>(sorted_unique, std::move(sorted), comp);
+    }
+
+private:
+    bool dup_throw;
+};
+
+
+template<typename Comp>
+class as_flat_set_custom_t : public step_wrapper<as_flat_set_custom_t<Comp> > {
+public:
+    as_flat_set_custom_t(Comp &&c, bool throw_on_dup) : comp(std::move(c)), dup_throw(throw_on_dup) {}
+
+    template<typename T>
+    flat_set<T, Comp> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use as_flat_set on an unbounded stream");
+
+        auto out = collector<T>();
+        out.reserve(s->hint());
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    flat_set_collector<Comp, T> collector() { return flat_set_collector<Comp, T>(std::move(comp), dup_throw); }
+
+private:
+    Comp comp;
+    bool dup_throw;
+};
+
+
+class as_flat_set_t : public step_wrapper<as_flat_set_t> {
+public:
+    as_flat_set_t(bool throw_on_dup = true) : dup_throw(throw_on_dup) {}
+
+    as_flat_set_t operator()(bool throw_on_dup = true) noexcept {
+        return as_flat_set_t(throw_on_dup);
+    }
+
+    template<typename Comp>
+    auto operator()(Comp comp, bool throw_on_dup = true) {
+        return as_flat_set_custom_t(member_comparer(std::move(comp)), throw_on_dup);
+    }
+
+    template<typename KeyFunc, typename Comp>
+    auto operator()(KeyFunc keyFunc, Comp comp, bool throw_on_dup = true) {
+        return as_flat_set_custom_t(member_comparer_custom(keyFunc, std::move(comp)), throw_on_dup);
+    }
+
+    template<typename T>
+    flat_set<T> stream(streamer_t<T> &st, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        return as_flat_set_custom_t<std::less<T> >(std::less<T>(), dup_throw).stream(st, s, unbounded);
+    }
+
+    template<typename T>
+    flat_set_collector<std::less<T>, T> collector() { return flat_set_collector<std::less<T>, T>(std::less<T>(), dup_throw); }
+
+private:
+    bool dup_throw;
+};
+
+
+
+template<typename Comp>
+class as_sorted_vector_custom_t : public step_wrapper<as_sorted_vector_custom_t<Comp> > {
+public:
+    as_sorted_vector_custom_t(Comp &&c) : comp(std::move(c)) {}
+
+    template<typename T>
+    std::vector<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use as_sorted_vector on an unbounded stream");
+
+        auto out = collector<T>();
+        out.reserve(s->hint());
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    sorting_collector<Comp, T> collector() { return sorting_collector<Comp, T>(std::move(comp)); }
+
+private:
+    Comp comp;
+};
+
+
+class as_sorted_vector_t : public step_wrapper<as_sorted_vector_t> {
+public:
+    constexpr as_sorted_vector_t &operator()() noexcept { return *this; }
+
+    template<typename Comp>
+    auto operator()(Comp comp) {
+        return as_sorted_vector_custom_t(member_comparer(std::move(comp)));
+    }
+
+    template<typename KeyFunc, typename Comp>
+    auto operator()(KeyFunc keyFunc, Comp comp) {
+        return as_sorted_vector_custom_t(member_comparer_custom(keyFunc, std::move(comp)));
+    }
+
+    template<typename T>
+    std::vector<T> stream(streamer_t<T> &st, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        return as_sorted_vector_custom_t<std::less<T> >(std::less<T>()).stream(st, s, unbounded);
+    }
+
+    template<typename T>
+    sorting_collector<std::less<T>, T> collector() { return sorting_collector<std::less<T>, T>(std::less<T>()); }
+};
+
+
+}  // namespace detail
+
+
+static detail::as_flat_set_t as_flat_set;
+static detail::as_sorted_vector_t as_sorted_vector;
+
+
+namespace detail {
+    inline void flat_set_unused_warnings() {
+        as_flat_set();
+        as_sorted_vector();
+    }
+} // namespace detail
+
+} // namespace streamer
+
+#endif
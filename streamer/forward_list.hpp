@@ -11,17 +11,46 @@ namespace streamer {
 namespace detail {
 
     
+template<typename T>
+class forward_list_collector : public collector_sink<forward_list_collector<T>, T> {
+public:
+    forward_list_collector() : out(), last(out.before_begin()) {}
+
+    forward_list_collector(forward_list_collector<T> &&other) 
+        : out(std::move(other.out)), last(out.before_begin()) {
+        for(auto it = out.begin(); it != out.end(); ++it)
+            last = it;
+    }
+
+    bool on_next(T &&value) override {
+        last = out.insert_after(last, std::move(value));
+        return true;
+    }
+
+    std::forward_list<T> result() { return std::move(out); }
+
+private:
+    std::forward_list<T> out;
+    typename std::forward_list<T>::iterator last;
+};
+
+
 class as_forward_list_t : public step_wrapper<as_forward_list_t> {
 public:
     constexpr as_forward_list_t &operator()() noexcept { return *this; }
 
     template<typename T>
-    std::forward_list<T> stream(streamer_t<T> &st, std::unique_ptr<step<T> > &, bool &unbounded) {
+    std::forward_list<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
         if(unbounded)
             throw unbounded_stream("cannot use as_forward_list on an unbounded stream");
 
-        return std::forward_list<T>(st.begin(), st.end());
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
     }
+
+    template<typename T>
+    forward_list_collector<T> collector() { return forward_list_collector<T>(); }
 };
 
 
@@ -0,0 +1,154 @@
+#ifndef STREAMER_FUSED_HPP
+#define STREAMER_FUSED_HPP
+
+#include "base.hpp"
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+template<typename Cont, typename T>
+class fused_cont_source {
+public:
+    using value_type = T;
+
+    fused_cont_source(Cont &&c) : cont(std::move(c)), it() {}
+
+    std::optional<T> get() {
+        // the iterator is only taken once the pipeline stops being moved around
+        if(!it)
+            it.emplace(std::begin(cont));
+        if(*it == std::end(cont))
+            return {};
+        T value = std::move(**it);
+        ++*it;
+        return {std::move(value)};
+    }
+private:
+    Cont cont;
+    std::optional<decltype(std::begin(cont))> it;
+};
+
+
+template<typename It, typename T>
+class fused_it_source {
+public:
+    using value_type = T;
+
+    fused_it_source(It &&begin_it, It &&end_it) : it(std::move(begin_it)), end(std::move(end_it)) {}
+
+    std::optional<T> get() {
+        if(it == end)
+            return {};
+        T value = *it;
+        ++it;
+        return {std::move(value)};
+    }
+private:
+    It it;
+    It end;
+};
+
+
+template<typename Src, typename T>
+class fused_step : public step<T> {
+public:
+    fused_step(Src &&s) : src(std::move(s)) {}
+
+    std::optional<T> get() override { return src.get(); }
+private:
+    Src src;
+};
+
+
+template<typename Step, typename Src, typename = void>
+struct has_fuse : std::false_type {};
+
+template<typename Step, typename Src>
+struct has_fuse<Step, Src, std::void_t<decltype(std::declval<Step&>().fuse(std::declval<Src>(), std::declval<bool&>()))> >
+    : std::true_type {};
+
+
+} // namespace detail
+
+
+
+template<typename Src>
+class fused_t {
+public:
+    using value_type = typename Src::value_type;
+
+    fused_t(Src &&s, bool unbound) : src(std::move(s)), unbounded(unbound) {}
+
+    fused_t(const fused_t<Src> &) = delete;
+    fused_t<Src> &operator=(const fused_t<Src> &) = delete;
+
+    fused_t(fused_t<Src> &&) = default;
+    fused_t<Src> &operator=(fused_t<Src> &&) = default;
+
+    streamer_t<value_type> erase() && {
+        auto ptr = new detail::fused_step<Src, value_type>(std::move(src));
+        return streamer_t<value_type>(std::unique_ptr<detail::step<value_type> >(ptr), unbounded);
+    }
+
+    bool unbound() const noexcept { return unbounded; }
+
+private:
+    template<typename S, typename Step>
+    friend auto operator>>(fused_t<S> &&f, detail::step_wrapper<Step> &step);
+
+    Src src;
+    bool unbounded;
+};
+
+
+
+template<typename It>
+auto stream_fused(It begin, It end) {
+    using T = typename detail::remove_ref_cv<decltype(*begin)>::type;
+    using ItType = typename detail::remove_ref_cv<It>::type;
+    return fused_t(detail::fused_it_source<ItType, T>(std::move(begin), std::move(end)), false);
+}
+
+template<typename T>
+auto stream_fused(const T *p, std::size_t n) {
+    return stream_fused(p, p + n);
+}
+
+template<typename Cont>
+auto stream_fused(Cont &cont) {
+    return stream_fused(std::begin(cont), std::end(cont));
+}
+
+template<typename Cont>
+auto stream_fused(Cont &&cont) {
+    using T = typename detail::remove_ref_cv<decltype(*std::begin(cont))>::type;
+    using ContType = typename detail::remove_ref_cv<Cont>::type;
+    return fused_t(detail::fused_cont_source<ContType, T>(std::move(cont)), false);
+}
+
+
+
+template<typename Src, typename Step>
+auto operator>>(fused_t<Src> &&f, detail::step_wrapper<Step> &step) {
+    if constexpr(detail::has_fuse<Step, Src>::value) {
+        bool unbounded = f.unbounded;
+        auto next = step.get_derived().fuse(std::move(f.src), unbounded);
+        return fused_t<decltype(next)>(std::move(next), unbounded);
+    } else {
+        return std::move(f).erase() >> step;
+    }
+}
+
+template<typename Src, typename Step>
+auto operator>>(fused_t<Src> &&f, detail::step_wrapper<Step> &&step) {
+    return std::move(f) >> step;
+}
+
+
+} // namespace streamer
+
+#endif
@@ -0,0 +1,247 @@
+#ifndef STREAMER_GROUP_REDUCE_HPP
+#define STREAMER_GROUP_REDUCE_HPP
+
+#include "base.hpp"
+#include "flat_hash.hpp"
+#include "parallel.hpp"
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+// the op of count_by
+struct count_one {
+    template<typename T>
+    constexpr std::size_t operator()(std::size_t n, const T &) const noexcept { return n + 1; }
+};
+
+
+// the combine of a group_reduce given none, whose accumulators cannot be joined
+struct no_combine {};
+
+
+// Map is a std::map, std::unordered_map or flat_hash_map from each key to its accumulator
+template<typename Map, typename KeyFunc, typename BiFunc, typename T>
+class group_reduce_collector : public collector_sink<group_reduce_collector<Map, KeyFunc, BiFunc, T>, T> {
+public:
+    using K = typename Map::key_type;
+    using R = typename Map::mapped_type;
+
+    group_reduce_collector(KeyFunc &&keyFunc, R &&init_value, BiFunc &&f, Map &&m)
+        : k(std::move(keyFunc)), init(std::move(init_value)), func(std::move(f)), out(std::move(m)) {}
+
+    // the key of the accumulator value would be folded into
+    decltype(auto) key(T &value) { return k(value); }
+
+    bool on_next(T &&value) override { return fold(k(value), std::move(value)); }
+
+    // as on_next, given the key(value) already worked out
+    template<typename Key>
+    bool fold(Key &&key, T &&value) {
+        R &acc = accumulator(std::forward<Key>(key));
+        acc = func(std::move(acc), std::move(value));
+        return true;
+    }
+
+    Map result() { return std::move(out); }
+
+private:
+    // the key is only copied when it starts a new group, whose accumulator is a copy of init
+    template<typename Key>
+    R &accumulator(Key &&key) {
+        if constexpr(keeps_order<Map>::value) {
+            auto it = out.lower_bound(key);
+            if(it == out.end() || out.key_comp()(key, it->first))
+                it = out.emplace_hint(it, K(std::forward<Key>(key)), init);
+            return it->second;
+        } else {
+            return out.try_emplace(std::forward<Key>(key), init).first->second;
+        }
+    }
+
+    KeyFunc k;
+    R init;
+    BiFunc func;
+    Map out;
+};
+
+
+template<template<typename...> class MapT, typename KeyFunc, typename I, typename BiFunc, typename Combine>
+class group_reduce_t : public step_wrapper<group_reduce_t<MapT, KeyFunc, I, BiFunc, Combine> > {
+public:
+    group_reduce_t(KeyFunc &&keyFunc, I &&init_value, BiFunc &&f, Combine &&c)
+        : k(std::move(keyFunc)), init(std::move(init_value)), func(std::move(f)), combine(std::move(c)) {}
+
+    template<typename T>
+    auto stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use group_reduce on an unbounded stream");
+
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    auto collector() {
+        using K = typename remove_ref_cv<decltype(k(std::declval<T&>()))>::type;
+        using R = typename remove_ref_cv<decltype(func(std::move(init), std::declval<T>()))>::type;
+        using Map = MapT<K, R>;
+        return group_reduce_collector<Map, KeyFunc, BiFunc, T>(std::move(k), R(std::move(init)), std::move(func), Map());
+    }
+
+    // with a combine, each chunk folds its elements into accumulators of its own, kept in
+    // one map per shard of the keys. each shard's maps are then joined in chunk order with
+    // combine on one thread, so memory grows with the number of keys rather than the number
+    // of elements. without one, the elements are passed to the shard of their key as by
+    // as_grouping, and each shard folds them in stream order, so every element is held
+    // until then.
+    template<typename T, typename Pipeline>
+    auto run(parallel_streamer_t<T, Pipeline> &&p) {
+        if constexpr(std::is_same<Combine, no_combine>::value) {
+            return sharded_collect(*this, std::move(p));
+        } else {
+            using U = typename parallel_streamer_t<T, Pipeline>::value_type;
+            using Collector = decltype(collector<U>());
+            using K = typename Collector::K;
+            using Map = decltype(std::declval<Collector&>().result());
+            constexpr bool hashable = std::is_default_constructible<std::hash<K> >::value;
+
+            // keys without a std::hash all go to a single shard
+            const Collector proto = collector<U>();
+            std::size_t shards = hashable ? p.thread_count() : 1;
+            std::vector<std::vector<Map> > partials(p.chunk_total(), std::vector<Map>(shards));
+
+            p.for_each_chunk([&](std::size_t c, auto src) {
+                std::vector<Collector> cols(shards, proto);
+                while(auto value = src.get()) {
+                    auto &&key = cols[0].key(*value);
+                    std::size_t shard = 0;
+                    if constexpr(hashable) {
+                        if(shards > 1)
+                            shard = shard_of(std::hash<K>()(key), shards);
+                    }
+                    cols[shard].fold(std::forward<decltype(key)>(key), *std::move(value));
+                }
+                for(std::size_t s = 0; s < shards; s++)
+                    partials[c][s] = cols[s].result();
+            });
+
+            std::vector<std::optional<Map> > results(shards);
+            p.for_each_task(shards, [&](std::size_t shard) {
+                Map out = std::move(partials[0][shard]);
+                for(std::size_t c = 1; c < partials.size(); c++) {
+                    for(auto &entry : partials[c][shard]) {
+                        auto it = out.find(entry.first);
+                        if(it == out.end())
+                            out.try_emplace(entry.first, std::move(entry.second));
+                        else
+                            it->second = combine(std::move(it->second), std::move(entry.second));
+                    }
+                    partials[c][shard] = Map();
+                }
+                results[shard].emplace(std::move(out));
+            });
+
+            return join_shards(results);
+        }
+    }
+
+private:
+    KeyFunc k;
+    I init;
+    BiFunc func;
+    Combine combine;
+};
+
+
+template<template<typename...> class MapT, typename KeyFunc, typename I, typename BiFunc, typename Combine>
+struct parallel_terminal<group_reduce_t<MapT, KeyFunc, I, BiFunc, Combine> > : std::true_type {};
+
+
+template<template<typename...> class MapT, typename KeyFunc, typename I, typename BiFunc, typename Combine>
+auto group_reduce_of(KeyFunc &&k, I &&init, BiFunc &&op, Combine &&combine) {
+    return group_reduce_t<MapT, KeyFunc, I, BiFunc, Combine>(
+        std::move(k), std::move(init), std::move(op), std::move(combine));
+}
+
+
+}  // namespace detail
+
+
+
+// folds the elements of each key into an accumulator of its own, starting from a copy of
+// init: acc = op(std::move(acc), element). returns a std::map from each key to its
+// accumulator. KeyFunc may be a member function or member variable. after parallel,
+// every element is held until it is folded, as by as_grouping, unless given a combine.
+template<typename KeyFunc, typename T, typename BiFunc>
+auto group_reduce(KeyFunc k, T init, BiFunc op) {
+    return detail::group_reduce_of<std::map>(
+        detail::member_mapper(std::move(k)), std::move(init), std::move(op), detail::no_combine());
+}
+
+// combine(acc1, acc2) joins the accumulators of the same key from two parts of the stream,
+// which lets a parallel stream fold each of its chunks on its own thread
+template<typename KeyFunc, typename T, typename BiFunc, typename Combine>
+auto group_reduce(KeyFunc k, T init, BiFunc op, Combine combine) {
+    return detail::group_reduce_of<std::map>(
+        detail::member_mapper(std::move(k)), std::move(init), std::move(op), std::move(combine));
+}
+
+
+template<typename KeyFunc, typename T, typename BiFunc>
+auto hash_group_reduce(KeyFunc k, T init, BiFunc op) {
+    return detail::group_reduce_of<std::unordered_map>(
+        detail::member_mapper(std::move(k)), std::move(init), std::move(op), detail::no_combine());
+}
+
+template<typename KeyFunc, typename T, typename BiFunc, typename Combine>
+auto hash_group_reduce(KeyFunc k, T init, BiFunc op, Combine combine) {
+    return detail::group_reduce_of<std::unordered_map>(
+        detail::member_mapper(std::move(k)), std::move(init), std::move(op), std::move(combine));
+}
+
+
+template<typename KeyFunc, typename T, typename BiFunc>
+auto flat_hash_group_reduce(KeyFunc k, T init, BiFunc op) {
+    return detail::group_reduce_of<flat_hash_map>(
+        detail::member_mapper(std::move(k)), std::move(init), std::move(op), detail::no_combine());
+}
+
+template<typename KeyFunc, typename T, typename BiFunc, typename Combine>
+auto flat_hash_group_reduce(KeyFunc k, T init, BiFunc op, Combine combine) {
+    return detail::group_reduce_of<flat_hash_map>(
+        detail::member_mapper(std::move(k)), std::move(init), std::move(op), std::move(combine));
+}
+
+
+
+// the number of elements with each key, as a std::map
+template<typename KeyFunc>
+auto count_by(KeyFunc k) {
+    return group_reduce(std::move(k), std::size_t(0), detail::count_one(), std::plus<std::size_t>());
+}
+
+template<typename KeyFunc>
+auto hash_count_by(KeyFunc k) {
+    return hash_group_reduce(std::move(k), std::size_t(0), detail::count_one(), std::plus<std::size_t>());
+}
+
+template<typename KeyFunc>
+auto flat_hash_count_by(KeyFunc k) {
+    return flat_hash_group_reduce(std::move(k), std::size_t(0), detail::count_one(), std::plus<std::size_t>());
+}
+
+
+} // namespace streamer
+
+#endif
@@ -9,6 +9,41 @@
 namespace streamer {
 
 
+namespace detail {
+
+
+template<typename KeyFunc, typename ValueFunc, typename Comp, typename T>
+class grouping_collector : public collector_sink<grouping_collector<KeyFunc, ValueFunc, Comp, T>, T> {
+public:
+    using K = typename remove_ref_cv<decltype(std::declval<KeyFunc&>()(std::declval<T&>()))>::type;
+    using V = typename remove_ref_cv<decltype(std::declval<ValueFunc&>()(std::declval<T>()))>::type;
+
+    grouping_collector(KeyFunc &&keyFunc, ValueFunc &&valueFunc, Comp &&comp)
+        : k(std::move(keyFunc)), v(std::move(valueFunc)), out(std::move(comp)) {}
+
+    // the key value would be stored under
+    decltype(auto) key(T &value) { return k(value); }
+
+    bool on_next(T &&value) override {
+        // the key is only copied when it starts a new group
+        auto &&key = k(value);
+        auto it = out.lower_bound(key);
+        if(it == out.end() || out.key_comp()(key, it->first))
+            it = out.emplace_hint(it, K(std::forward<decltype(key)>(key)), std::vector<V>());
+
+        it->second.push_back(v(std::move(value)));
+        return true;
+    }
+
+    std::map<K, std::vector<V>, Comp> result() { return std::move(out); }
+
+private:
+    KeyFunc k;
+    ValueFunc v;
+    std::map<K, std::vector<V>, Comp> out;
+};
+
+
 template<typename KeyFunc, typename ValueFunc, typename Comp>
 class as_grouping_t : public step_wrapper<as_grouping_t<KeyFunc, ValueFunc, Comp> > {
 public:
@@ -20,17 +55,14 @@ public:
         if(unbounded)
             throw unbounded_stream("cannot use as_grouping on an unbounded stream");
 
-        using K = typename remove_ref_cv<decltype(k(*s->get()))>::type;
-        using V = typename remove_ref_cv<decltype(v(*std::move(s->get())))>::type;
-
-        std::map<K, std::vector<V>, Comp> out(c);
-
-        while(std::optional<T> value = s->get()) {
-            K key = k(*value);
-            out[std::move(key)].push_back(v(*std::move(value)));
-        }
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
+    }
 
-        return out;
+    template<typename T>
+    grouping_collector<KeyFunc, ValueFunc, Comp, T> collector() {
+        return grouping_collector<KeyFunc, ValueFunc, Comp, T>(std::move(k), std::move(v), std::move(c));
     }
 
 private:
@@ -52,6 +84,12 @@ public:
         return as_grouping_t(std::move(k), std::move(v), std::less<K>()).stream(st, s, unbounded);
     }
 
+    template<typename T>
+    auto collector() {
+        using K = typename remove_ref_cv<decltype(k(std::declval<T&>()))>::type;
+        return as_grouping_t(std::move(k), std::move(v), std::less<K>()).template collector<T>();
+    }
+
 private:
     KeyFunc k;
     ValueFunc v;
@@ -69,6 +107,12 @@ public:
         return as_grouping_t(std::move(k), identity<T>(), std::less<K>()).stream(st, s, unbounded);
     }
 
+    template<typename T>
+    auto collector() {
+        using K = typename remove_ref_cv<decltype(k(std::declval<T&>()))>::type;
+        return as_grouping_t(std::move(k), identity<T>(), std::less<K>()).template collector<T>();
+    }
+
 private:
     KeyFunc k;
 };
@@ -0,0 +1,172 @@
+#ifndef STREAMER_HASH_GROUPING_HPP
+#define STREAMER_HASH_GROUPING_HPP
+
+#include "base.hpp"
+#include "flat_hash.hpp"
+#include "unordered_map.hpp"
+#include <unordered_map>
+#include <vector>
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+// Map is a std::unordered_map or a flat_hash_map of std::vectors
+template<typename Map, typename KeyFunc, typename ValueFunc, typename T>
+class hash_grouping_collector : public collector_sink<hash_grouping_collector<Map, KeyFunc, ValueFunc, T>, T> {
+public:
+    using K = typename Map::key_type;
+
+    hash_grouping_collector(KeyFunc &&keyFunc, ValueFunc &&valueFunc, Map &&m)
+        : k(std::move(keyFunc)), v(std::move(valueFunc)), out(std::move(m)) {}
+
+    // the key of the group value would be added to
+    decltype(auto) key(T &value) { return k(value); }
+
+    bool on_next(T &&value) override {
+        // the key is only copied when it starts a new group
+        auto &&key = k(value);
+        auto it = out.find(key);
+        if(it == out.end())
+            it = out.try_emplace(K(std::forward<decltype(key)>(key))).first;
+
+        it->second.push_back(v(std::move(value)));
+        return true;
+    }
+
+    Map result() { return std::move(out); }
+
+private:
+    KeyFunc k;
+    ValueFunc v;
+    Map out;
+};
+
+
+template<template<typename...> class MapT, typename KeyFunc, typename ValueFunc, typename Hash, typename Eq>
+class as_hash_grouping_t : public step_wrapper<as_hash_grouping_t<MapT, KeyFunc, ValueFunc, Hash, Eq> > {
+public:
+    as_hash_grouping_t(KeyFunc &&keyFunc, ValueFunc &&valueFunc, Hash &&hash, Eq &&eq)
+        : k(std::move(keyFunc)), v(std::move(valueFunc)), h(std::move(hash)), e(std::move(eq)) {}
+
+    template<typename T>
+    auto stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use as_hash_grouping on an unbounded stream");
+
+        // the number of groups is unknown, so nothing is reserved
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    auto collector() {
+        using K = typename remove_ref_cv<decltype(k(std::declval<T&>()))>::type;
+        auto hash = hash_or_default<K>(std::move(h));
+        auto eq = equal_to_or_default<K>(std::move(e));
+
+        if constexpr(std::is_same<ValueFunc, element_value>::value) {
+            using Map = MapT<K, std::vector<T>, decltype(hash), decltype(eq)>;
+            return hash_grouping_collector<Map, KeyFunc, identity<T>, T>(
+                std::move(k), identity<T>(), Map(0, std::move(hash), std::move(eq)));
+        } else {
+            using V = typename remove_ref_cv<decltype(v(std::declval<T>()))>::type;
+            using Map = MapT<K, std::vector<V>, decltype(hash), decltype(eq)>;
+            return hash_grouping_collector<Map, KeyFunc, ValueFunc, T>(
+                std::move(k), std::move(v), Map(0, std::move(hash), std::move(eq)));
+        }
+    }
+
+private:
+    KeyFunc k;
+    ValueFunc v;
+    Hash h;
+    Eq e;
+};
+
+
+template<template<typename...> class MapT, typename KeyFunc, typename ValueFunc, typename Hash, typename Eq>
+auto as_hash_grouping_of(KeyFunc &&k, ValueFunc &&v, Hash &&h, Eq &&e) {
+    return as_hash_grouping_t<MapT, KeyFunc, ValueFunc, Hash, Eq>(
+        std::move(k), std::move(v), std::move(h), std::move(e));
+}
+
+
+}  // namespace detail
+
+
+
+template<typename KeyFunc, typename ValueFunc, typename Hash, typename Eq>
+auto as_hash_grouping(KeyFunc k, ValueFunc v, Hash h, Eq e) {
+    return detail::as_hash_grouping_of<std::unordered_map>(
+        detail::member_mapper(std::move(k)),
+        detail::member_mapper(std::move(v)),
+        std::move(h),
+        std::move(e)
+    );
+}
+
+
+template<typename KeyFunc, typename ValueFunc>
+auto as_hash_grouping(KeyFunc k, ValueFunc v) {
+    return detail::as_hash_grouping_of<std::unordered_map>(
+        detail::member_mapper(std::move(k)),
+        detail::member_mapper(std::move(v)),
+        detail::default_hash(),
+        detail::default_equal_to()
+    );
+}
+
+
+template<typename KeyFunc>
+auto as_hash_grouping(KeyFunc k) {
+    return detail::as_hash_grouping_of<std::unordered_map>(
+        detail::member_mapper(std::move(k)),
+        detail::element_value(),
+        detail::default_hash(),
+        detail::default_equal_to()
+    );
+}
+
+
+
+template<typename KeyFunc, typename ValueFunc, typename Hash, typename Eq>
+auto as_flat_hash_grouping(KeyFunc k, ValueFunc v, Hash h, Eq e) {
+    return detail::as_hash_grouping_of<flat_hash_map>(
+        detail::member_mapper(std::move(k)),
+        detail::member_mapper(std::move(v)),
+        std::move(h),
+        std::move(e)
+    );
+}
+
+
+template<typename KeyFunc, typename ValueFunc>
+auto as_flat_hash_grouping(KeyFunc k, ValueFunc v) {
+    return detail::as_hash_grouping_of<flat_hash_map>(
+        detail::member_mapper(std::move(k)),
+        detail::member_mapper(std::move(v)),
+        detail::default_hash(),
+        detail::default_equal_to()
+    );
+}
+
+
+template<typename KeyFunc>
+auto as_flat_hash_grouping(KeyFunc k) {
+    return detail::as_hash_grouping_of<flat_hash_map>(
+        detail::member_mapper(std::move(k)),
+        detail::element_value(),
+        detail::default_hash(),
+        detail::default_equal_to()
+    );
+}
+
+
+} // namespace streamer
+
+#endif
@@ -0,0 +1,352 @@
+#ifndef STREAMER_HEAVY_HITTERS_HPP
+#define STREAMER_HEAVY_HITTERS_HPP
+
+#include "base.hpp"
+#include "flat_hash.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+namespace streamer {
+
+
+// a key with the number of times it was seen. count may be more than the real number
+// by up to error, but never less.
+template<typename K>
+struct heavy_hitter {
+    K key;
+    std::uint64_t count;
+    std::uint64_t error;
+};
+
+
+// the Space-Saving algorithm: counts the keys inserted using a fixed number of counters.
+// a key without a counter takes over the one with the lowest count, adding to it, so
+// any key seen more than size() / capacity times is sure to have a counter. the
+// counters are kept in a min-heap by count.
+template<typename K, typename Hash = std::hash<K>, typename Eq = std::equal_to<K> >
+class space_saving {
+public:
+    using value_type = K;
+
+    explicit space_saving(std::size_t capacity, const Hash &hash = Hash(), const Eq &eq = Eq())
+        : cap(capacity), slots(), heap(), index(0, hash, eq), total(0) {
+        if(cap == 0)
+            throw std::invalid_argument("space_saving capacity must be at least 1");
+        slots.reserve(cap);
+        heap.reserve(cap);
+        index.reserve(cap);
+    }
+
+    void insert(const K &key) { insert(key, 1); }
+
+    void insert(const K &key, std::uint64_t weight) {
+        total += weight;
+
+        auto it = index.find(key);
+        if(it != index.end()) {
+            slot &s = slots[it->second];
+            s.count += weight;
+            sift_down(s.pos);
+        } else if(slots.size() < cap) {
+            index.try_emplace(key, slots.size());
+            slots.push_back({key, weight, 0, heap.size()});
+            heap.push_back(slots.size() - 1);
+            sift_up(heap.size() - 1);
+        } else {
+            std::size_t i = heap[0];
+            slot &s = slots[i];
+            index.erase(s.key);
+            s.key = key;
+            s.error = s.count;
+            s.count += weight;
+            index.try_emplace(key, i);
+            sift_down(0);
+        }
+    }
+
+    // adds the counts of other. a key counted only on one side may have been seen on
+    // the other up to that side's lowest count, which is added to its count and error.
+    void merge(const space_saving &other) {
+        std::uint64_t mine = floor();
+        std::uint64_t theirs = other.floor();
+        total += other.total;
+
+        std::vector<heavy_hitter<K> > all;
+        all.reserve(slots.size() + other.slots.size());
+        for(const slot &s : slots) {
+            auto it = other.index.find(s.key);
+            if(it != other.index.end()) {
+                const slot &o = other.slots[it->second];
+                all.push_back({s.key, s.count + o.count, s.error + o.error});
+            } else {
+                all.push_back({s.key, s.count + theirs, s.error + theirs});
+            }
+        }
+        for(const slot &o : other.slots) {
+            if(index.find(o.key) == index.end())
+                all.push_back({o.key, o.count + mine, o.error + mine});
+        }
+
+        auto by_count = [](const heavy_hitter<K> &a, const heavy_hitter<K> &b) { return a.count > b.count; };
+        if(all.size() > cap) {
+            std::nth_element(all.begin(), all.begin() + static_cast<std::ptrdiff_t>(cap), all.end(), by_count);
+            all.resize(cap);
+        }
+
+        slots.clear();
+        heap.clear();
+        index.clear();
+        for(heavy_hitter<K> &h : all) {
+            index.try_emplace(h.key, slots.size());
+            slots.push_back({std::move(h.key), h.count, h.error, heap.size()});
+            heap.push_back(slots.size() - 1);
+            sift_up(heap.size() - 1);
+        }
+    }
+
+    // the n keys with the highest counts, highest first
+    std::vector<heavy_hitter<K> > top(std::size_t n) const {
+        std::vector<heavy_hitter<K> > out;
+        out.reserve(slots.size());
+        for(const slot &s : slots)
+            out.push_back({s.key, s.count, s.error});
+
+        auto by_count = [](const heavy_hitter<K> &a, const heavy_hitter<K> &b) { return a.count > b.count; };
+        n = std::min(n, out.size());
+        std::partial_sort(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(n), out.end(), by_count);
+        out.resize(n);
+        return out;
+    }
+
+    // an upper bound on the number of times key was seen
+    std::uint64_t estimate(const K &key) const {
+        auto it = index.find(key);
+        return it != index.end() ? slots[it->second].count : floor();
+    }
+
+    // the total weight of the keys inserted
+    std::uint64_t size() const noexcept { return total; }
+    std::size_t capacity() const noexcept { return cap; }
+
+private:
+    struct slot {
+        K key;
+        std::uint64_t count;
+        std::uint64_t error;
+        std::size_t pos;
+    };
+
+    // the most a key without a counter can have been seen
+    std::uint64_t floor() const noexcept { return slots.size() < cap ? 0 : slots[heap[0]].count; }
+
+    bool lower(std::size_t a, std::size_t b) const noexcept { return slots[heap[a]].count < slots[heap[b]].count; }
+
+    void swap_at(std::size_t a, std::size_t b) noexcept {
+        std::swap(heap[a], heap[b]);
+        slots[heap[a]].pos = a;
+        slots[heap[b]].pos = b;
+    }
+
+    void sift_up(std::size_t i) noexcept {
+        while(i > 0 && lower(i, (i - 1) / 2)) {
+            swap_at(i, (i - 1) / 2);
+            i = (i - 1) / 2;
+        }
+    }
+
+    void sift_down(std::size_t i) noexcept {
+        for(;;) {
+            std::size_t least = i;
+            std::size_t left = 2 * i + 1;
+            std::size_t right = left + 1;
+            if(left < heap.size() && lower(left, least))
+                least = left;
+            if(right < heap.size() && lower(right, least))
+                least = right;
+            if(least == i)
+                return;
+            swap_at(i, least);
+            i = least;
+        }
+    }
+
+    std::size_t cap;
+    std::vector<slot> slots;
+    std::vector<std::size_t> heap;
+    flat_hash_map<K, std::size_t, Hash, Eq> index;
+    std::uint64_t total;
+};
+
+
+// a Count-Min sketch: estimates how often each key was seen, in depth rows of width
+// counters. each row adds a key to one counter picked by its hash, and the estimate is
+// the lowest of the key's counters. it never undercounts, and overcounts by more than
+// about 2.7 / width of size() with a chance of about e^-depth.
+template<typename K, typename Hash = std::hash<K> >
+class count_min {
+public:
+    using value_type = K;
+
+    explicit count_min(std::size_t width = 2048, std::size_t depth = 4, const Hash &h = Hash())
+        : w(width), d(depth), hash(h), counters(width * depth, 0), total(0) {
+        if(w == 0 || d == 0)
+            throw std::invalid_argument("count_min width and depth must be at least 1");
+    }
+
+    void insert(const K &key) { insert(key, 1); }
+
+    void insert(const K &key, std::uint64_t weight) {
+        total += weight;
+        std::uint64_t h = detail::mix_hash(static_cast<std::uint64_t>(hash(key)));
+        for(std::size_t row = 0; row < d; row++)
+            counters[row * w + column(h, row)] += weight;
+    }
+
+    std::uint64_t estimate(const K &key) const {
+        std::uint64_t h = detail::mix_hash(static_cast<std::uint64_t>(hash(key)));
+        std::uint64_t least = counters[column(h, 0)];
+        for(std::size_t row = 1; row < d; row++)
+            least = std::min(least, counters[row * w + column(h, row)]);
+        return least;
+    }
+
+    void merge(const count_min &other) {
+        if(other.w != w || other.d != d)
+            throw std::invalid_argument("cannot merge count_min sketches of different sizes");
+        for(std::size_t i = 0; i < counters.size(); i++)
+            counters[i] += other.counters[i];
+        total += other.total;
+    }
+
+    std::uint64_t size() const noexcept { return total; }
+
+private:
+    // the rows use the hashes h1 + row * h2, made from the two halves of one hash
+    std::size_t column(std::uint64_t h, std::size_t row) const noexcept {
+        std::uint64_t h1 = h & 0xffffffffull;
+        std::uint64_t h2 = (h >> 32) | 1;
+        return static_cast<std::size_t>((h1 + row * h2) % w);
+    }
+
+    std::size_t w;
+    std::size_t d;
+    Hash hash;
+    std::vector<std::uint64_t> counters;
+    std::uint64_t total;
+};
+
+
+
+namespace detail {
+
+
+template<typename KeyFunc, typename T>
+class heavy_hitters_collector : public collector_sink<heavy_hitters_collector<KeyFunc, T>, T> {
+public:
+    using K = typename remove_ref_cv<decltype(std::declval<KeyFunc&>()(std::declval<T&>()))>::type;
+
+    heavy_hitters_collector(KeyFunc &&keyFunc, std::size_t count, std::size_t capacity)
+        : k(std::move(keyFunc)), n(count), out(capacity) {}
+
+    bool on_next(T &&value) override {
+        out.insert(k(value));
+        return true;
+    }
+
+    std::vector<heavy_hitter<K> > result() const { return out.top(n); }
+
+    space_saving<K> &sketch() noexcept { return out; }
+
+private:
+    KeyFunc k;
+    std::size_t n;
+    space_saving<K> out;
+};
+
+
+template<typename KeyFunc>
+class heavy_hitters_t : public step_wrapper<heavy_hitters_t<KeyFunc> > {
+public:
+    heavy_hitters_t(KeyFunc &&keyFunc, std::size_t count, std::size_t capacity)
+        : k(std::move(keyFunc)), n(count), cap(capacity) {
+        if(cap == 0)
+            throw std::invalid_argument("space_saving capacity must be at least 1");
+    }
+
+    template<typename T>
+    auto stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use heavy_hitters on an unbounded stream");
+
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    auto collector() {
+        if constexpr(std::is_same<KeyFunc, element_value>::value)
+            return heavy_hitters_collector<identity<T>, T>(identity<T>(), n, cap);
+        else
+            return heavy_hitters_collector<KeyFunc, T>(std::move(k), n, cap);
+    }
+
+    // each chunk is counted on its own thread, then the counters are merged in the
+    // order of the chunks
+    template<typename T, typename Pipeline>
+    auto run(parallel_streamer_t<T, Pipeline> &&p) {
+        using U = typename parallel_streamer_t<T, Pipeline>::value_type;
+        using Collector = decltype(collector<U>());
+
+        auto proto = collector<U>();
+        auto make = [&proto]() { return proto; };
+        collect_chunks(p, make, [&proto](Collector &partial) {
+            proto.sketch().merge(partial.sketch());
+        });
+        return proto.result();
+    }
+
+private:
+    KeyFunc k;
+    std::size_t n;
+    std::size_t cap;
+};
+
+
+template<typename KeyFunc>
+struct parallel_terminal<heavy_hitters_t<KeyFunc> > : std::true_type {};
+
+
+}  // namespace detail
+
+
+
+// the n most frequent elements, most frequent first, counted with 10 * n counters (at
+// least 64)
+inline auto heavy_hitters(std::size_t n) {
+    return detail::heavy_hitters_t<detail::element_value>(detail::element_value(), n, std::max<std::size_t>(10 * n, 64));
+}
+
+// the n most frequent keys, where KeyFunc may be a member function or member variable
+template<typename KeyFunc>
+auto heavy_hitters(std::size_t n, KeyFunc k) {
+    auto key = detail::member_mapper(std::move(k));
+    return detail::heavy_hitters_t<decltype(key)>(std::move(key), n, std::max<std::size_t>(10 * n, 64));
+}
+
+template<typename KeyFunc>
+auto heavy_hitters(std::size_t n, KeyFunc k, std::size_t capacity) {
+    auto key = detail::member_mapper(std::move(k));
+    return detail::heavy_hitters_t<decltype(key)>(std::move(key), n, capacity);
+}
+
+
+} // namespace streamer
+
+#endif
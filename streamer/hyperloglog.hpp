@@ -0,0 +1,233 @@
+#ifndef STREAMER_HYPERLOGLOG_HPP
+#define STREAMER_HYPERLOGLOG_HPP
+
+#include "base.hpp"
+#include "flat_hash.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+inline unsigned leading_zeros(std::uint64_t x) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+    return x == 0 ? 64 : static_cast<unsigned>(__builtin_clzll(x));
+#else
+    unsigned n = 0;
+    for(std::uint64_t bit = std::uint64_t(1) << 63; bit != 0 && !(x & bit); bit >>= 1)
+        n++;
+    return n;
+#endif
+}
+
+
+inline unsigned checked_precision(unsigned precision) {
+    if(precision < 4 || precision > 18)
+        throw std::invalid_argument("hyperloglog precision must be between 4 and 18");
+    return precision;
+}
+
+
+} // namespace detail
+
+
+
+// a HyperLogLog sketch: an estimate of the number of distinct elements inserted, in
+// 2^precision bytes. the first precision bits of an element's hash pick a register,
+// which keeps the longest run of leading zeros seen in the rest of the hash. the
+// standard error is about 1.04 / sqrt(2^precision), 0.81% for the default of 14 (16KB).
+// sketches with the same precision can be merged, giving the sketch of all the elements
+// inserted into either.
+template<typename T, typename Hash = std::hash<T> >
+class hyperloglog {
+public:
+    using value_type = T;
+
+    explicit hyperloglog(unsigned precision = 14, const Hash &h = Hash())
+        : p(detail::checked_precision(precision)), hash(h), registers(std::size_t(1) << p, 0) {}
+
+    void insert(const T &value) { insert_hash(detail::mix_hash(static_cast<std::uint64_t>(hash(value)))); }
+
+    // for a hash whose bits are already evenly spread
+    void insert_hash(std::uint64_t h) noexcept {
+        std::size_t index = static_cast<std::size_t>(h >> (64 - p));
+        std::uint64_t rest = h << p;
+        auto rank = static_cast<std::uint8_t>(std::min(detail::leading_zeros(rest), 64 - p) + 1);
+        if(registers[index] < rank)
+            registers[index] = rank;
+    }
+
+    void merge(const hyperloglog &other) {
+        if(other.p != p)
+            throw std::invalid_argument("cannot merge hyperloglog sketches of different precision");
+        for(std::size_t i = 0; i < registers.size(); i++)
+            registers[i] = std::max(registers[i], other.registers[i]);
+    }
+
+    // the estimated number of distinct elements. small counts use linear counting of the
+    // empty registers, which is more accurate there.
+    double estimate() const noexcept {
+        double m = static_cast<double>(registers.size());
+        double sum = 0.0;
+        std::size_t zeros = 0;
+        for(std::uint8_t r : registers) {
+            sum += std::ldexp(1.0, -static_cast<int>(r));
+            if(r == 0)
+                zeros++;
+        }
+
+        double alpha = 0.7213 / (1.0 + 1.079 / m);
+        double e = alpha * m * m / sum;
+        if(e <= 2.5 * m && zeros > 0)
+            return m * std::log(m / static_cast<double>(zeros));
+        return e;
+    }
+
+    std::uint64_t count() const noexcept { return static_cast<std::uint64_t>(std::llround(estimate())); }
+
+    unsigned precision() const noexcept { return p; }
+
+    void clear() noexcept { std::fill(registers.begin(), registers.end(), 0); }
+
+private:
+    unsigned p;
+    Hash hash;
+    std::vector<std::uint8_t> registers;
+};
+
+
+
+namespace detail {
+
+
+template<typename KeyFunc, typename T>
+class approx_distinct_collector : public collector_sink<approx_distinct_collector<KeyFunc, T>, T> {
+public:
+    using K = typename remove_ref_cv<decltype(std::declval<KeyFunc&>()(std::declval<T&>()))>::type;
+
+    approx_distinct_collector(KeyFunc &&keyFunc, unsigned precision) : k(std::move(keyFunc)), out(precision) {}
+
+    bool on_next(T &&value) override {
+        out.insert(k(value));
+        return true;
+    }
+
+    std::uint64_t result() const noexcept { return out.count(); }
+
+    hyperloglog<K> &sketch() noexcept { return out; }
+
+private:
+    KeyFunc k;
+    hyperloglog<K> out;
+};
+
+
+template<typename KeyFunc>
+class approx_distinct_custom_t : public step_wrapper<approx_distinct_custom_t<KeyFunc> > {
+public:
+    approx_distinct_custom_t(KeyFunc &&keyFunc, unsigned precision)
+        : k(std::move(keyFunc)), p(checked_precision(precision)) {}
+
+    template<typename T>
+    std::uint64_t stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use approx_distinct on an unbounded stream");
+
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    auto collector() {
+        if constexpr(std::is_same<KeyFunc, element_value>::value)
+            return approx_distinct_collector<identity<T>, T>(identity<T>(), p);
+        else
+            return approx_distinct_collector<KeyFunc, T>(std::move(k), p);
+    }
+
+    // each chunk fills its own registers on its thread, which are then merged
+    template<typename T, typename Pipeline>
+    std::uint64_t run(parallel_streamer_t<T, Pipeline> &&p_stream) {
+        using U = typename parallel_streamer_t<T, Pipeline>::value_type;
+        using Collector = decltype(collector<U>());
+
+        auto proto = collector<U>();
+        auto make = [&proto]() { return proto; };
+        collect_chunks(p_stream, make, [&proto](Collector &partial) {
+            proto.sketch().merge(partial.sketch());
+        });
+        return proto.result();
+    }
+
+private:
+    KeyFunc k;
+    unsigned p;
+};
+
+
+class approx_distinct_t : public step_wrapper<approx_distinct_t> {
+public:
+    constexpr approx_distinct_t &operator()() noexcept { return *this; }
+
+    // elements are counted by the key k returns, which may be a member pointer
+    template<typename KeyFunc, typename = typename std::enable_if<!std::is_arithmetic<KeyFunc>::value>::type>
+    auto operator()(KeyFunc k, unsigned precision = 14) {
+        auto key = member_mapper(std::move(k));
+        return approx_distinct_custom_t<decltype(key)>(std::move(key), precision);
+    }
+
+    auto operator()(unsigned precision) {
+        return approx_distinct_custom_t<element_value>(element_value(), precision);
+    }
+
+    template<typename T>
+    std::uint64_t stream(streamer_t<T> &st, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        return custom().stream(st, s, unbounded);
+    }
+
+    template<typename T>
+    auto collector() { return custom().template collector<T>(); }
+
+    template<typename T, typename Pipeline>
+    std::uint64_t run(parallel_streamer_t<T, Pipeline> &&p) { return custom().run(std::move(p)); }
+
+private:
+    static approx_distinct_custom_t<element_value> custom() {
+        return approx_distinct_custom_t<element_value>(element_value(), 14);
+    }
+};
+
+
+template<typename KeyFunc>
+struct parallel_terminal<approx_distinct_custom_t<KeyFunc> > : std::true_type {};
+
+template<>
+struct parallel_terminal<approx_distinct_t> : std::true_type {};
+
+
+}  // namespace detail
+
+
+static detail::approx_distinct_t approx_distinct;
+
+
+namespace detail {
+    inline void hyperloglog_unused_warnings() {
+        approx_distinct();
+    }
+} // namespace detail
+
+} // namespace streamer
+
+#endif
@@ -9,6 +9,34 @@
 namespace streamer {
 
 
+namespace detail {
+
+
+template<typename Char, typename T>
+class join_collector : public collector_sink<join_collector<Char, T>, T> {
+public:
+    join_collector(std::basic_string<Char> &&delimiter) : delim(std::move(delimiter)), out(), first(true) {}
+
+    bool on_next(T &&value) override {
+        if(!first)
+            out << delim;
+        first = false;
+        out << std::move(value);
+        return true;
+    }
+
+    std::basic_string<Char> result() const { return out.str(); }
+
+private:
+    std::basic_string<Char> delim;
+    std::basic_stringstream<Char> out;
+    bool first;
+};
+
+
+} // namespace detail
+
+
 template<typename Char>
 class join : public detail::step_wrapper<join<Char> > {
 public:
@@ -20,19 +48,14 @@ public:
         if(unbounded)
             throw unbounded_stream("cannot use join on an unbounded stream");
 
-        std::optional<T> value = s->get();
-        if(!value)
-            return {};
-        std::basic_stringstream<Char> out;
-
-        out << *std::move(value);
-
-        while((value = s->get()))
-            out << delim << *std::move(value);
-
-        return out.str();
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
     }
 
+    template<typename T>
+    detail::join_collector<Char, T> collector() { return detail::join_collector<Char, T>(std::move(delim)); }
+
 private:
     std::basic_string<Char> delim;
 };
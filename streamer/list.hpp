@@ -11,17 +11,37 @@ namespace streamer {
 namespace detail {
 
     
+template<typename T>
+class list_collector : public collector_sink<list_collector<T>, T> {
+public:
+    bool on_next(T &&value) override {
+        out.push_back(std::move(value));
+        return true;
+    }
+
+    std::list<T> result() { return std::move(out); }
+
+private:
+    std::list<T> out;
+};
+
+
 class as_list_t : public step_wrapper<as_list_t> {
 public:
     constexpr as_list_t &operator()() noexcept { return *this; }
 
     template<typename T>
-    std::list<T> stream(streamer_t<T> &st, std::unique_ptr<step<T> > &, bool &unbounded) {
+    std::list<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
         if(unbounded)
             throw unbounded_stream("cannot use as_list on an unbounded stream");
 
-        return std::list<T>(st.begin(), st.end());
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
     }
+
+    template<typename T>
+    list_collector<T> collector() { return list_collector<T>(); }
 };
 
 
@@ -18,6 +18,44 @@ public:
 namespace detail {
 
 
+template<typename KeyFunc, typename ValueFunc, typename Comp, typename T>
+class map_collector : public collector_sink<map_collector<KeyFunc, ValueFunc, Comp, T>, T> {
+public:
+    using K = typename remove_ref_cv<decltype(std::declval<KeyFunc&>()(std::declval<T&>()))>::type;
+    using V = typename remove_ref_cv<decltype(std::declval<ValueFunc&>()(std::declval<T>()))>::type;
+
+    map_collector(KeyFunc &&keyFunc, ValueFunc &&valueFunc, Comp &&comp, bool throw_on_dup)
+        : k(std::move(keyFunc)), v(std::move(valueFunc)), out(std::move(comp)), dup_throw(throw_on_dup) {}
+
+    // the key value would be stored under
+    decltype(auto) key(T &value) { return k(value); }
+
+    bool on_next(T &&value) override {
+        // the key is only looked at by reference until it is known to be new
+        auto &&key = k(value);
+        auto it = out.lower_bound(key);
+        if(it != out.end() && !out.key_comp()(key, it->first)) {
+            if(dup_throw)
+                throw duplicate_map_key("key already exists in map");
+            return true;
+        }
+
+        // key may refer into value, so it has to be taken before value is moved
+        K new_key(std::forward<decltype(key)>(key));
+        out.emplace_hint(it, std::move(new_key), v(std::move(value)));
+        return true;
+    }
+
+    std::map<K, V, Comp> result() { return std::move(out); }
+
+private:
+    KeyFunc k;
+    ValueFunc v;
+    std::map<K, V, Comp> out;
+    bool dup_throw;
+};
+
+
 template<typename KeyFunc, typename ValueFunc, typename Comp>
 class as_map_t : public step_wrapper<as_map_t<KeyFunc, ValueFunc, Comp> > {
 public:
@@ -29,19 +67,14 @@ public:
         if(unbounded)
             throw unbounded_stream("cannot use as_map on an unbounded stream");
 
-        using K = typename remove_ref_cv<decltype(k(*s->get()))>::type;
-        using V = typename remove_ref_cv<decltype(v(*std::move(s->get())))>::type;
-
-        std::map<K, V, Comp> out(c);
-
-        while(std::optional<T> value = s->get()) {
-            K key = k(*value);
-            auto pair = std::make_pair(std::move(key), v(*std::move(value)));
-            if(!out.insert(std::move(pair)).second && dup_throw)
-                throw duplicate_map_key("key already exists in map");;
-        }
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
+    }
 
-        return out;
+    template<typename T>
+    map_collector<KeyFunc, ValueFunc, Comp, T> collector() {
+        return map_collector<KeyFunc, ValueFunc, Comp, T>(std::move(k), std::move(v), std::move(c), dup_throw);
     }
 
 private:
@@ -64,6 +97,12 @@ public:
         return as_map_t(std::move(k), std::move(v), std::less<K>(), dup_throw).stream(st, s, unbounded);
     }
 
+    template<typename T>
+    auto collector() {
+        using K = typename remove_ref_cv<decltype(k(std::declval<T&>()))>::type;
+        return as_map_t(std::move(k), std::move(v), std::less<K>(), dup_throw).template collector<T>();
+    }
+
 private:
     KeyFunc k;
     ValueFunc v;
@@ -83,6 +122,12 @@ public:
         return as_map_t(std::move(k), identity<T>(), std::less<K>(), dup_throw).stream(st, s, unbounded);
     }
 
+    template<typename T>
+    auto collector() {
+        using K = typename remove_ref_cv<decltype(k(std::declval<T&>()))>::type;
+        return as_map_t(std::move(k), identity<T>(), std::less<K>(), dup_throw).template collector<T>();
+    }
+
 private:
     KeyFunc k;
     bool dup_throw;
@@ -90,6 +135,34 @@ private:
 
 
 
+template<typename KeyFunc, typename ValueFunc, typename Comp, typename T>
+class multimap_collector : public collector_sink<multimap_collector<KeyFunc, ValueFunc, Comp, T>, T> {
+public:
+    using K = typename remove_ref_cv<decltype(std::declval<KeyFunc&>()(std::declval<T&>()))>::type;
+    using V = typename remove_ref_cv<decltype(std::declval<ValueFunc&>()(std::declval<T>()))>::type;
+
+    multimap_collector(KeyFunc &&keyFunc, ValueFunc &&valueFunc, Comp &&comp)
+        : k(std::move(keyFunc)), v(std::move(valueFunc)), out(std::move(comp)) {}
+
+    // the key value would be stored under
+    decltype(auto) key(T &value) { return k(value); }
+
+    bool on_next(T &&value) override {
+        // key may refer into value, so it has to be taken before value is moved
+        K key(k(value));
+        out.emplace(std::move(key), v(std::move(value)));
+        return true;
+    }
+
+    std::multimap<K, V, Comp> result() { return std::move(out); }
+
+private:
+    KeyFunc k;
+    ValueFunc v;
+    std::multimap<K, V, Comp> out;
+};
+
+
 template<typename KeyFunc, typename ValueFunc, typename Comp>
 class as_multimap_t : public step_wrapper<as_multimap_t<KeyFunc, ValueFunc, Comp> > {
 public:
@@ -101,17 +174,14 @@ public:
         if(unbounded)
             throw unbounded_stream("cannot use as_multimap on an unbounded stream");
 
-        using K = typename remove_ref_cv<decltype(k(*s->get()))>::type;
-        using V = typename remove_ref_cv<decltype(v(*std::move(s->get())))>::type;
-
-        std::multimap<K, V, Comp> out(c);
-
-        while(std::optional<T> value = s->get()) {
-            K key = k(*value);
-            out.insert(std::move(key), v(*std::move(value)));
-        }
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
+    }
 
-        return out;
+    template<typename T>
+    multimap_collector<KeyFunc, ValueFunc, Comp, T> collector() {
+        return multimap_collector<KeyFunc, ValueFunc, Comp, T>(std::move(k), std::move(v), std::move(c));
     }
 
 private:
@@ -133,6 +203,12 @@ public:
         return as_multimap_t(std::move(k), std::move(v), std::less<K>()).stream(st, s, unbounded);
     }
 
+    template<typename T>
+    auto collector() {
+        using K = typename remove_ref_cv<decltype(k(std::declval<T&>()))>::type;
+        return as_multimap_t(std::move(k), std::move(v), std::less<K>()).template collector<T>();
+    }
+
 private:
     KeyFunc k;
     ValueFunc v;
@@ -150,6 +226,12 @@ public:
         return as_multimap_t(std::move(k), identity<T>(), std::less<K>()).stream(st, s, unbounded);
     }
 
+    template<typename T>
+    auto collector() {
+        using K = typename remove_ref_cv<decltype(k(std::declval<T&>()))>::type;
+        return as_multimap_t(std::move(k), identity<T>(), std::less<K>()).template collector<T>();
+    }
+
 private:
     KeyFunc k;
 };
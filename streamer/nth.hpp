@@ -0,0 +1,277 @@
+#ifndef STREAMER_NTH_HPP
+#define STREAMER_NTH_HPP
+
+#include "base.hpp"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <vector>
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+// the element of each of ranks in the sorted values, in the order the ranks are given.
+// every rank must be less than values.size(). values are left partly sorted. each
+// selection only searches the part after the previous rank, so a few ranks cost little
+// more than one.
+template<typename T, typename Comp>
+std::vector<T> select_ranks(std::vector<T> &values, const std::vector<std::size_t> &ranks, Comp &comp) {
+    std::vector<std::size_t> order(ranks.size());
+    for(std::size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&ranks](std::size_t a, std::size_t b) { return ranks[a] < ranks[b]; });
+
+    auto from = values.begin();
+    for(std::size_t i : order) {
+        auto nth = values.begin() + static_cast<std::ptrdiff_t>(ranks[i]);
+        if(nth >= from) {
+            std::nth_element(from, nth, values.end(), comp);
+            from = nth + 1;
+        }
+    }
+
+    std::vector<T> out;
+    out.reserve(ranks.size());
+    for(std::size_t rank : ranks)
+        out.push_back(values[rank]);
+    return out;
+}
+
+
+// rank fraction of the way through size elements, rounded down
+inline std::size_t fraction_rank(double fraction, std::size_t size) noexcept {
+    return static_cast<std::size_t>(fraction * static_cast<double>(size - 1));
+}
+
+
+struct nth_index {
+    std::size_t index;
+    std::size_t operator()(std::size_t) const noexcept { return index; }
+};
+
+
+struct nth_fraction {
+    double fraction;
+    std::size_t operator()(std::size_t size) const noexcept { return fraction_rank(fraction, size); }
+};
+
+
+// Rank gives the position wanted from the number of elements
+template<typename Comp, typename Rank, typename T>
+class nth_collector : public collector_sink<nth_collector<Comp, Rank, T>, T> {
+public:
+    nth_collector(Comp &&c, Rank r) : comp(std::move(c)), rank(r), out() {}
+
+    bool on_next(T &&value) override {
+        out.push_back(std::move(value));
+        return true;
+    }
+
+    void reserve(size_hint hint) {
+        if(hint.is_exact())
+            out.reserve(out.size() + hint.size);
+    }
+
+    std::optional<T> result() {
+        if(out.empty())
+            return {};
+
+        std::size_t i = rank(out.size());
+        if(i >= out.size())
+            return {};
+
+        std::nth_element(out.begin(), out.begin() + static_cast<std::ptrdiff_t>(i), out.end(), comp);
+        return {std::move(out[i])};
+    }
+
+private:
+    Comp comp;
+    Rank rank;
+    std::vector<T> out;
+};
+
+
+template<typename Comp, typename T>
+class percentiles_collector : public collector_sink<percentiles_collector<Comp, T>, T> {
+public:
+    percentiles_collector(Comp &&c, const std::vector<double> &ps) : comp(std::move(c)), fractions(ps), out() {}
+
+    bool on_next(T &&value) override {
+        out.push_back(std::move(value));
+        return true;
+    }
+
+    void reserve(size_hint hint) {
+        if(hint.is_exact())
+            out.reserve(out.size() + hint.size);
+    }
+
+    std::vector<T> result() {
+        if(out.empty())
+            return {};
+
+        std::vector<std::size_t> ranks;
+        ranks.reserve(fractions.size());
+        for(double p : fractions)
+            ranks.push_back(fraction_rank(p, out.size()));
+        return select_ranks(out, ranks, comp);
+    }
+
+private:
+    Comp comp;
+    std::vector<double> fractions;
+    std::vector<T> out;
+};
+
+
+
+template<typename Comp, typename Rank>
+class nth_t : public step_wrapper<nth_t<Comp, Rank> > {
+public:
+    nth_t(Comp &&c, Rank r) : comp(std::move(c)), rank(r) {}
+
+    template<typename T>
+    std::optional<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream(std::is_same<Rank, nth_index>::value ? "cannot use nth on an unbounded stream"
+                                                                        : "cannot use median on an unbounded stream");
+
+        auto out = collector<T>();
+        out.reserve(s->hint());
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    auto collector() {
+        auto c = less_or_default<T>(std::move(comp));
+        return nth_collector<decltype(c), Rank, T>(std::move(c), rank);
+    }
+
+private:
+    Comp comp;
+    Rank rank;
+};
+
+
+template<typename Comp>
+class percentiles_t : public step_wrapper<percentiles_t<Comp> > {
+public:
+    percentiles_t(Comp &&c, std::vector<double> &&ps) : comp(std::move(c)), fractions(std::move(ps)) {
+        for(double p : fractions) {
+            if(!(p >= 0.0 && p <= 1.0))
+                throw std::invalid_argument("percentiles must be between 0 and 1");
+        }
+    }
+
+    template<typename T>
+    std::vector<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use percentiles on an unbounded stream");
+
+        auto out = collector<T>();
+        out.reserve(s->hint());
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    auto collector() {
+        auto c = less_or_default<T>(std::move(comp));
+        return percentiles_collector<decltype(c), T>(std::move(c), fractions);
+    }
+
+private:
+    Comp comp;
+    std::vector<double> fractions;
+};
+
+
+class median_t : public step_wrapper<median_t> {
+public:
+    constexpr median_t &operator()() noexcept { return *this; }
+
+    template<typename Comp>
+    auto operator()(Comp comp) {
+        auto c = member_comparer(std::move(comp));
+        return nth_t<decltype(c), nth_fraction>(std::move(c), nth_fraction{0.5});
+    }
+
+    template<typename KeyFunc, typename Comp>
+    auto operator()(KeyFunc k, Comp comp) {
+        auto c = member_comparer_custom(std::move(k), std::move(comp));
+        return nth_t<decltype(c), nth_fraction>(std::move(c), nth_fraction{0.5});
+    }
+
+    template<typename T>
+    std::optional<T> stream(streamer_t<T> &st, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        return custom().stream(st, s, unbounded);
+    }
+
+    template<typename T>
+    auto collector() { return custom().template collector<T>(); }
+
+private:
+    static nth_t<default_less, nth_fraction> custom() {
+        return nth_t<default_less, nth_fraction>(default_less(), nth_fraction{0.5});
+    }
+};
+
+
+}  // namespace detail
+
+
+
+// the element which would be at index k if the stream were sorted, or an empty
+// std::optional if the stream has k elements or fewer
+inline auto nth(std::size_t k) {
+    return detail::nth_t<detail::default_less, detail::nth_index>(detail::default_less(), detail::nth_index{k});
+}
+
+template<typename Comp>
+auto nth(std::size_t k, Comp comp) {
+    auto c = detail::member_comparer(std::move(comp));
+    return detail::nth_t<decltype(c), detail::nth_index>(std::move(c), detail::nth_index{k});
+}
+
+template<typename KeyFunc, typename Comp>
+auto nth(std::size_t k, KeyFunc keyFunc, Comp comp) {
+    auto c = detail::member_comparer_custom(std::move(keyFunc), std::move(comp));
+    return detail::nth_t<decltype(c), detail::nth_index>(std::move(c), detail::nth_index{k});
+}
+
+
+// the element fraction p of the way through the sorted stream, for each p in ps
+inline auto percentiles(std::vector<double> ps) {
+    return detail::percentiles_t<detail::default_less>(detail::default_less(), std::move(ps));
+}
+
+template<typename Comp>
+auto percentiles(Comp comp, std::vector<double> ps) {
+    auto c = detail::member_comparer(std::move(comp));
+    return detail::percentiles_t<decltype(c)>(std::move(c), std::move(ps));
+}
+
+template<typename KeyFunc, typename Comp>
+auto percentiles(KeyFunc keyFunc, Comp comp, std::vector<double> ps) {
+    auto c = detail::member_comparer_custom(std::move(keyFunc), std::move(comp));
+    return detail::percentiles_t<decltype(c)>(std::move(c), std::move(ps));
+}
+
+
+static detail::median_t median;
+
+
+namespace detail {
+    inline void nth_unused_warnings() {
+        median();
+    }
+} // namespace detail
+
+} // namespace streamer
+
+#endif
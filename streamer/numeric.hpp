@@ -0,0 +1,189 @@
+#ifndef STREAMER_NUMERIC_HPP
+#define STREAMER_NUMERIC_HPP
+
+#include "base.hpp"
+#include "simd.hpp"
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+template<typename T>
+class sum_collector : public collector_sink<sum_collector<T>, T> {
+public:
+    static_assert(std::is_arithmetic<T>::value, "sum needs arithmetic elements");
+
+    sum_collector() : acc() {}
+
+    bool on_next(T &&value) override {
+        acc += value;
+        return true;
+    }
+
+    bool on_batch(T *values, std::size_t n) override {
+        add(values, n);
+        return true;
+    }
+
+    void add(const T *values, std::size_t n) noexcept { acc += simd_sum(values, n); }
+
+    sum_type<T> result() const noexcept { return acc; }
+
+private:
+    sum_type<T> acc;
+};
+
+
+template<typename T>
+class minmax_collector : public collector_sink<minmax_collector<T>, T> {
+public:
+    static_assert(std::is_arithmetic<T>::value, "minmax needs arithmetic elements");
+
+    bool on_next(T &&value) override {
+        add(&value, 1);
+        return true;
+    }
+
+    bool on_batch(T *values, std::size_t n) override {
+        add(values, n);
+        return true;
+    }
+
+    void add(const T *values, std::size_t n) noexcept {
+        if(n == 0)
+            return;
+
+        std::pair<T, T> found = simd_minmax(values, n);
+        if(!out) {
+            out = found;
+        } else {
+            if(found.first < out->first)
+                out->first = found.first;
+            if(out->second < found.second)
+                out->second = found.second;
+        }
+    }
+
+    std::optional<std::pair<T, T> > result() const noexcept { return out; }
+
+private:
+    std::optional<std::pair<T, T> > out;
+};
+
+
+template<typename T>
+class mean_collector : public collector_sink<mean_collector<T>, T> {
+public:
+    static_assert(std::is_arithmetic<T>::value, "mean needs arithmetic elements");
+
+    mean_collector() : acc(), count(0) {}
+
+    bool on_next(T &&value) override {
+        acc += value;
+        count++;
+        return true;
+    }
+
+    bool on_batch(T *values, std::size_t n) override {
+        add(values, n);
+        return true;
+    }
+
+    void add(const T *values, std::size_t n) noexcept {
+        acc += simd_wide_sum(values, n);
+        count += n;
+    }
+
+    std::optional<double> result() const noexcept {
+        if(count == 0)
+            return {};
+        return static_cast<double>(acc) / static_cast<double>(count);
+    }
+
+private:
+    wide_sum_type<T> acc;
+    std::size_t count;
+};
+
+
+class sum_t : public step_wrapper<sum_t> {
+public:
+    constexpr sum_t &operator()() noexcept { return *this; }
+
+    template<typename T>
+    sum_type<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use sum on an unbounded stream");
+
+        return collect_numeric(*s, collector<T>());
+    }
+
+    template<typename T>
+    sum_collector<T> collector() { return sum_collector<T>(); }
+};
+
+
+class minmax_t : public step_wrapper<minmax_t> {
+public:
+    constexpr minmax_t &operator()() noexcept { return *this; }
+
+    template<typename T>
+    std::optional<std::pair<T, T> > stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use minmax on an unbounded stream");
+
+        return collect_numeric(*s, collector<T>());
+    }
+
+    template<typename T>
+    minmax_collector<T> collector() { return minmax_collector<T>(); }
+};
+
+
+class mean_t : public step_wrapper<mean_t> {
+public:
+    constexpr mean_t &operator()() noexcept { return *this; }
+
+    template<typename T>
+    std::optional<double> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use mean on an unbounded stream");
+
+        return collect_numeric(*s, collector<T>());
+    }
+
+    template<typename T>
+    mean_collector<T> collector() { return mean_collector<T>(); }
+};
+
+
+}  // namespace detail
+
+
+// the sum of the elements, in T after integer promotion (int for a char or short)
+static detail::sum_t sum;
+
+// the smallest and largest element, or an empty std::optional if there are none
+static detail::minmax_t minmax;
+
+// the average of the elements as a double, or an empty std::optional if there are none
+static detail::mean_t mean;
+
+
+namespace detail {
+    inline void numeric_unused_warnings() {
+        sum();
+        minmax();
+        mean();
+    }
+} // namespace detail
+
+} // namespace streamer
+
+#endif
@@ -2,7 +2,9 @@
 #define STREAMER_BASE_ORDER_HPP
 
 #include "base.hpp"
+#include <algorithm>
 #include <deque>
+#include <limits>
 
 
 namespace streamer {
@@ -44,7 +46,56 @@ public:
         return next_step->get();
     }
 
+    std::size_t get_batch(T *out, std::size_t count) override {
+        std::size_t written = next_step->get_batch(out, std::min(n, count));
+        n -= written;
+        return written;
+    }
+
+    void push(sink<T> &out) override {
+        if(n == 0) {
+            out.on_done();
+            return;
+        }
+        take_sink s(n, out);
+        next_step->push(s);
+    }
+
+    std::size_t discard(std::size_t count) override {
+        std::size_t dropped = next_step->discard(std::min(n, count));
+        n -= dropped;
+        return dropped;
+    }
+
+    size_hint hint() const override { return next_step->hint().capped(n); }
+
+    void limit(std::size_t count) override { next_step->limit(std::min(n, count)); }
+
 private:
+    class take_sink : public sink<T> {
+    public:
+        take_sink(std::size_t &amount, sink<T> &o) : n(amount), out(o) {}
+
+        // returns false as soon as the last element is taken, so nothing more is pulled
+        bool on_next(T &&value) override {
+            n--;
+            return out.on_next(std::move(value)) && n > 0;
+        }
+
+        bool on_batch(T *values, std::size_t count) override {
+            count = std::min(n, count);
+            n -= count;
+            return out.on_batch(values, count) && n > 0;
+        }
+
+        std::size_t demand() const override { return std::min(n, out.demand()); }
+        void on_done() override { out.on_done(); }
+
+    private:
+        std::size_t &n;
+        sink<T> &out;
+    };
+
     std::size_t n;
     std::unique_ptr<step<T> > next_step;
 };
@@ -57,13 +108,41 @@ public:
         : n(amount), next_step(std::move(next)) {}
 
     std::optional<T> get() override {
-        std::optional<T> value;
-        while((value = next_step->get()) && n > 0) {
-            n--;
-        }
-        return value;
+        skip_ahead();
+        return next_step->get();
+    }
+
+    std::size_t get_batch(T *out, std::size_t count) override {
+        skip_ahead();
+        return next_step->get_batch(out, count);
+    }
+
+    std::size_t discard(std::size_t count) override {
+        skip_ahead();
+        return next_step->discard(count);
+    }
+
+    void push(sink<T> &out) override {
+        skip_ahead();
+        next_step->push(out);
+    }
+
+    size_hint hint() const override { return next_step->hint().skipped(n); }
+
+    // the skipped elements are taken from the previous step as well
+    void limit(std::size_t count) override {
+        std::size_t most = std::numeric_limits<std::size_t>::max();
+        next_step->limit(count > most - n ? most : count + n);
     }
 private:
+    // O(1) when only random-access sources and size-preserving steps come before
+    void skip_ahead() {
+        if(n > 0) {
+            next_step->discard(n);
+            n = 0;
+        }
+    }
+
     std::size_t n;
     std::unique_ptr<step<T> > next_step;
 };
@@ -83,7 +162,31 @@ public:
             return {};
     }
 
+    void push(sink<T> &out) override {
+        take_while_sink s(pred, out);
+        next_step->push(s);
+    }
+
+    size_hint hint() const override { return next_step->hint().loosened(); }
+
 private:
+    class take_while_sink : public sink<T> {
+    public:
+        take_while_sink(UnaryPred &p, sink<T> &o) : pred(p), out(o) {}
+
+        bool on_next(T &&value) override {
+            return pred(value) && out.on_next(std::move(value));
+        }
+
+        // any element could be the one that ends the stream
+        std::size_t demand() const override { return 1; }
+        void on_done() override { out.on_done(); }
+
+    private:
+        UnaryPred &pred;
+        sink<T> &out;
+    };
+
     UnaryPred pred;
     std::unique_ptr<step<T> > next_step;
 };
@@ -105,6 +208,11 @@ public:
         done_skipping = true;
         return value;
     }
+
+    size_hint hint() const override { 
+        size_hint h = next_step->hint();
+        return done_skipping ? h : h.loosened();
+    }
 private:
     UnaryPred pred;
     bool done_skipping;
@@ -112,6 +220,90 @@ private:
 };
 
 
+template<typename Src>
+class fused_take {
+public:
+    using value_type = typename Src::value_type;
+
+    fused_take(Src &&s, std::size_t amount) : src(std::move(s)), n(amount) {}
+
+    std::optional<value_type> get() {
+        if(n == 0)
+            return {};
+
+        n--;
+        return src.get();
+    }
+private:
+    Src src;
+    std::size_t n;
+};
+
+
+template<typename Src>
+class fused_skip {
+public:
+    using value_type = typename Src::value_type;
+
+    fused_skip(Src &&s, std::size_t amount) : src(std::move(s)), n(amount) {}
+
+    std::optional<value_type> get() {
+        std::optional<value_type> value;
+        while((value = src.get()) && n > 0) {
+            n--;
+        }
+        return value;
+    }
+private:
+    Src src;
+    std::size_t n;
+};
+
+
+template<typename Src, typename UnaryPred>
+class fused_take_while {
+public:
+    using value_type = typename Src::value_type;
+
+    fused_take_while(Src &&s, UnaryPred &&p) : src(std::move(s)), pred(std::move(p)) {}
+
+    std::optional<value_type> get() {
+        std::optional<value_type> value = src.get();
+        if(value && pred(*value))
+            return value;
+        else
+            return {};
+    }
+private:
+    Src src;
+    UnaryPred pred;
+};
+
+
+template<typename Src, typename UnaryPred>
+class fused_skip_while {
+public:
+    using value_type = typename Src::value_type;
+
+    fused_skip_while(Src &&s, UnaryPred &&p) : src(std::move(s)), pred(std::move(p)), done_skipping(false) {}
+
+    std::optional<value_type> get() {
+        if(done_skipping)
+            return src.get();
+
+        std::optional<value_type> value;
+        while((value = src.get()) && pred(*value));
+
+        done_skipping = true;
+        return value;
+    }
+private:
+    Src src;
+    UnaryPred pred;
+    bool done_skipping;
+};
+
+
 } // namespace detail
 
 
@@ -123,10 +315,17 @@ public:
     template<typename T>
     streamer_t<T> &&stream(streamer_t<T> &st, std::unique_ptr<detail::step<T> > &s, bool &unbounded) {
         unbounded = false;
+        s->limit(n);
         s.reset(new detail::take_step<T>(n, std::move(s)));
         return std::move(st);
     }
 
+    template<typename Src>
+    auto fuse(Src src, bool &unbounded) {
+        unbounded = false;
+        return detail::fused_take<Src>(std::move(src), n);
+    }
+
 private:
     std::size_t n;
 };
@@ -142,6 +341,11 @@ public:
         return std::move(st);
     }
 
+    template<typename Src>
+    auto fuse(Src src, bool &) {
+        return detail::fused_skip<Src>(std::move(src), n);
+    }
+
 private:
     std::size_t n;
 };
@@ -159,6 +363,12 @@ public:
         return std::move(st);
     }
 
+    template<typename Src>
+    auto fuse(Src src, bool &unbounded) {
+        unbounded = false;
+        return detail::fused_take_while<Src, UnaryPred>(std::move(src), std::move(pred));
+    }
+
 private:
     UnaryPred pred;
 };
@@ -175,6 +385,11 @@ public:
         return std::move(st);
     }
 
+    template<typename Src>
+    auto fuse(Src src, bool &) {
+        return detail::fused_skip_while<Src, UnaryPred>(std::move(src), std::move(pred));
+    }
+
 private:
     UnaryPred pred;
 };
@@ -0,0 +1,804 @@
+#ifndef STREAMER_PARALLEL_HPP
+#define STREAMER_PARALLEL_HPP
+
+#include "base.hpp"
+#include "base_steps.hpp"
+#include "base_filter.hpp"
+#include "vector.hpp"
+#include "map.hpp"
+#include "grouping.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+inline std::size_t default_threads() noexcept {
+    std::size_t n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+
+} // namespace detail
+
+
+
+// a fixed set of threads which run the tasks of one job at a time. each thread starts
+// with a contiguous range of the tasks and steals from the other threads once it
+// runs out.
+class thread_pool {
+public:
+    explicit thread_pool(std::size_t threads = detail::default_threads())
+        : queues(new task_queue[threads > 0 ? threads : 1]),
+          queue_count(threads > 0 ? threads : 1),
+          job(nullptr),
+          generation(0),
+          stopping(false) {
+        // the thread calling run() works on the job too
+        for(std::size_t i = 1; i < queue_count; i++)
+            workers.emplace_back([this, i]() { work(i); });
+    }
+
+    thread_pool(const thread_pool &) = delete;
+    thread_pool &operator=(const thread_pool &) = delete;
+
+    ~thread_pool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for(std::thread &t : workers)
+            t.join();
+    }
+
+    std::size_t size() const noexcept { return queue_count; }
+
+    // calls func(i) for each i in [0, tasks) and waits for all of them to finish.
+    // the first exception thrown by func is rethrown once the remaining tasks are
+    // abandoned. a run() from inside one of this pool's tasks runs serially.
+    template<typename Func>
+    void run(std::size_t tasks, Func &&func) {
+        if(tasks == 0)
+            return;
+
+        if(current() == this || queue_count == 1) {
+            for(std::size_t i = 0; i < tasks; i++)
+                func(i);
+            return;
+        }
+
+        std::lock_guard<std::mutex> one_job_at_a_time(run_mutex);
+
+        using F = typename std::remove_reference<Func>::type;
+        job_t j(const_cast<void*>(static_cast<const void*>(&func)),
+                [](void *f, std::size_t i) { (*static_cast<F*>(f))(i); });
+        for(std::size_t q = 0; q < queue_count; q++) {
+            std::lock_guard<std::mutex> lock(queues[q].mutex);
+            for(std::size_t i = tasks * q / queue_count; i < tasks * (q + 1) / queue_count; i++)
+                queues[q].tasks.push_back(i);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &j;
+            generation++;
+        }
+        wake.notify_all();
+
+        execute(0, j);
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            finished.wait(lock, [&j]() { return j.active == 0; });
+            job = nullptr;
+        }
+
+        if(j.error)
+            std::rethrow_exception(j.error);
+    }
+
+private:
+    struct alignas(detail::cache_line) task_queue {
+        std::mutex mutex;
+        std::deque<std::size_t> tasks;
+    };
+
+    struct job_t {
+        job_t(void *f, void (*c)(void *, std::size_t))
+            : func(f), call(c), active(0), failed(false), error() {}
+
+        void *func;
+        void (*call)(void *, std::size_t);
+        std::size_t active;
+        std::atomic<bool> failed;
+        std::exception_ptr error;
+        std::mutex error_mutex;
+    };
+
+    static thread_pool *&current() noexcept {
+        static thread_local thread_pool *pool = nullptr;
+        return pool;
+    }
+
+    bool take(std::size_t id, std::size_t &task) {
+        {
+            task_queue &own = queues[id];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if(!own.tasks.empty()) {
+                task = own.tasks.front();
+                own.tasks.pop_front();
+                return true;
+            }
+        }
+
+        for(std::size_t k = 1; k < queue_count; k++) {
+            task_queue &other = queues[(id + k) % queue_count];
+            std::lock_guard<std::mutex> lock(other.mutex);
+            if(!other.tasks.empty()) {
+                task = other.tasks.back();
+                other.tasks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void execute(std::size_t id, job_t &j) {
+        thread_pool *outer = current();
+        current() = this;
+
+        std::size_t task;
+        while(take(id, task)) {
+            if(j.failed.load(std::memory_order_relaxed))
+                continue;
+            try {
+                j.call(j.func, task);
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(j.error_mutex);
+                if(!j.error)
+                    j.error = std::current_exception();
+                j.failed = true;
+            }
+        }
+
+        current() = outer;
+    }
+
+    void work(std::size_t id) {
+        std::size_t seen = 0;
+        for(;;) {
+            job_t *j;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this, seen]() { return stopping || generation != seen; });
+                if(stopping)
+                    return;
+                seen = generation;
+                j = job;
+                if(!j)
+                    continue;
+                j->active++;
+            }
+
+            execute(id, *j);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if(--j->active == 0)
+                    finished.notify_all();
+            }
+        }
+    }
+
+    std::unique_ptr<task_queue[]> queues;
+    std::size_t queue_count;
+    std::vector<std::thread> workers;
+
+    std::mutex run_mutex;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    job_t *job;
+    std::size_t generation;
+    bool stopping;
+};
+
+
+
+namespace detail {
+
+
+// the elements [begin, end) of an indexable step, as a fused source
+template<typename T>
+class chunk_source {
+public:
+    using value_type = T;
+
+    chunk_source(step<T> *s, std::size_t begin_index, std::size_t end_index)
+        : src(s), i(begin_index), end(end_index) {}
+
+    std::optional<T> get() {
+        if(i == end)
+            return {};
+        return {src->at(i++)};
+    }
+private:
+    step<T> *src;
+    std::size_t i;
+    std::size_t end;
+};
+
+
+// an indexable step holding the rest of s, which is materialized if s isn't indexable itself
+template<typename T>
+std::unique_ptr<step<T> > make_indexable(std::unique_ptr<step<T> > &s) {
+    if(s->indexable())
+        return std::move(s);
+
+    vector_collector<T> out;
+    out.reserve(s->hint());
+    s->push(out);
+    s.reset();
+    return std::unique_ptr<step<T> >(new cont_source<std::vector<T>, T>(out.result()));
+}
+
+
+// splits size elements into chunks for threads, enough of them for stealing to balance the load
+inline std::size_t chunk_count(std::size_t size, std::size_t threads) noexcept {
+    constexpr std::size_t min_chunk = 256;
+    std::size_t chunks = std::min(threads * 4, (size + min_chunk - 1) / min_chunk);
+    return chunks > 0 ? chunks : 1;
+}
+
+
+// runs func(i) for each i in [0, tasks) on pool, or on a pool of threads made for
+// the occasion if pool is null
+template<typename Func>
+void run_tasks(thread_pool *pool, std::size_t threads, std::size_t tasks, Func &&func) {
+    if(pool) {
+        pool->run(tasks, func);
+    } else {
+        thread_pool local(std::min(threads, tasks));
+        local.run(tasks, func);
+    }
+}
+
+
+// runs func(chunk, begin, end) for each chunk of [0, size)
+template<typename Func>
+void run_chunks(thread_pool *pool, std::size_t threads, std::size_t size, std::size_t chunks, Func &&func) {
+    run_tasks(pool, threads, chunks, [&](std::size_t c) { func(c, size * c / chunks, size * (c + 1) / chunks); });
+}
+
+
+template<typename Step>
+struct parallel_safe : std::false_type {};
+
+template<typename MemOrFunc>
+struct parallel_safe<mapping<MemOrFunc> > : std::true_type {};
+
+template<typename MemOrFunc>
+struct parallel_safe<flat_mapping<MemOrFunc> > : std::true_type {};
+
+template<typename UnaryPred>
+struct parallel_safe<filter<UnaryPred> > : std::true_type {};
+
+template<>
+struct parallel_safe<copied_t> : std::true_type {};
+
+
+struct parallel_identity {
+    template<typename Src>
+    Src operator()(Src src) const { return src; }
+};
+
+
+// applies Step after Prev to the source of each chunk. every chunk gets its own copy of step.
+template<typename Prev, typename Step>
+class parallel_compose {
+public:
+    parallel_compose(Prev &&p, Step &&s) : prev(std::move(p)), step(std::move(s)) {}
+
+    template<typename Src>
+    auto operator()(Src src) const {
+        bool unbounded = false;
+        Step copy = step;
+        return copy.fuse(prev(std::move(src)), unbounded);
+    }
+
+private:
+    Prev prev;
+    Step step;
+};
+
+
+template<typename T, typename Pipeline>
+class parallel_streamer_t {
+public:
+    using value_type = typename decltype(std::declval<const Pipeline&>()(std::declval<chunk_source<T> >()))::value_type;
+
+    parallel_streamer_t(std::unique_ptr<step<T> > &&s, Pipeline &&p, thread_pool *tp, std::size_t n, bool keep_order)
+        : source(std::move(s)), pipeline(std::move(p)), pool(tp), threads(n), ordered(keep_order) {}
+
+    parallel_streamer_t(parallel_streamer_t &&) = default;
+
+    template<typename Step>
+    auto then(Step &&s) && {
+        using Next = parallel_compose<Pipeline, typename remove_ref_cv<Step>::type>;
+        Next next(std::move(pipeline), std::move(s));
+        return parallel_streamer_t<T, Next>(std::move(source), std::move(next), pool, threads, ordered);
+    }
+
+    std::size_t thread_count() const { return pool ? pool->size() : threads; }
+
+    std::size_t chunk_total() const { return chunk_count(source->hint().size, thread_count()); }
+
+    // calls func(i) for each i in [0, tasks) on the threads
+    template<typename Func>
+    void for_each_task(std::size_t tasks, Func &&func) {
+        run_tasks(pool, threads, tasks, func);
+    }
+
+    // calls func(chunk, src) for each chunk on the threads, where src is the chunk's
+    // fused source with the pipeline applied. returns the number of chunks.
+    template<typename Func>
+    std::size_t for_each_chunk(Func &&func) {
+        std::size_t size = source->hint().size;
+        std::size_t chunks = chunk_total();
+
+        run_chunks(pool, threads, size, chunks, [&](std::size_t c, std::size_t begin, std::size_t end) {
+            func(c, pipeline(chunk_source<T>(source.get(), begin, end)));
+        });
+
+        source.reset();
+        return chunks;
+    }
+
+    // runs the pipeline over every chunk and joins the results into a single stream
+    streamer_t<value_type> run() && {
+        using U = value_type;
+
+        std::vector<std::vector<U> > results(chunk_total());
+        std::vector<std::size_t> finish_order(results.size());
+        std::atomic<std::size_t> finished(0);
+
+        std::size_t chunks = for_each_chunk([&](std::size_t c, auto src) {
+            std::vector<U> &out = results[c];
+            while(auto value = src.get())
+                out.push_back(*std::move(value));
+            finish_order[finished++] = c;
+        });
+
+        std::size_t total = 0;
+        for(const auto &r : results)
+            total += r.size();
+
+        std::vector<U> all;
+        all.reserve(total);
+        for(std::size_t k = 0; k < chunks; k++) {
+            std::vector<U> &r = results[ordered ? k : finish_order[k]];
+            all.insert(all.end(), std::make_move_iterator(r.begin()), std::make_move_iterator(r.end()));
+        }
+
+        return streamer_t<U>(std::move(all));
+    }
+
+private:
+    std::unique_ptr<step<T> > source;
+    Pipeline pipeline;
+    thread_pool *pool;
+    std::size_t threads;
+    bool ordered;
+};
+
+
+} // namespace detail
+
+
+
+class parallel : public detail::step_wrapper<parallel> {
+public:
+    parallel(std::size_t threads = detail::default_threads(), bool keep_order = true)
+        : pool(nullptr), n(threads > 0 ? threads : 1), ordered(keep_order) {}
+
+    parallel(thread_pool &executor, bool keep_order = true)
+        : pool(&executor), n(executor.size()), ordered(keep_order) {}
+
+    template<typename T>
+    auto stream(streamer_t<T> &, std::unique_ptr<detail::step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use parallel on an unbounded stream");
+
+        return detail::parallel_streamer_t<T, detail::parallel_identity>(
+            detail::make_indexable(s), detail::parallel_identity(), pool, n, ordered);
+    }
+
+private:
+    thread_pool *pool;
+    std::size_t n;
+    bool ordered;
+};
+
+
+
+namespace detail {
+
+
+// combines the partial results pairwise, (0, 1) (2, 3) ... then (0, 2) (4, 6) ... and so
+// on, so the order of the combine calls only depends on the number of chunks
+template<typename R, typename Combine>
+std::optional<R> combine_tree(std::vector<padded<std::optional<R> > > &partials, Combine &combine) {
+    std::size_t n = partials.size();
+    for(std::size_t stride = 1; stride < n; stride *= 2) {
+        for(std::size_t i = 0; i + stride < n; i += 2 * stride) {
+            std::optional<R> &left = partials[i].value;
+            std::optional<R> &right = partials[i + stride].value;
+            if(!left)
+                left = std::move(right);
+            else if(right)
+                left = combine(*std::move(left), *std::move(right));
+        }
+    }
+    return n > 0 ? std::move(partials[0].value) : std::nullopt;
+}
+
+
+// runs a collector from make() over each chunk of p on its thread, then passes them to
+// merge one at a time in the order of the chunks. a collector may end its chunk early by
+// returning false from on_next.
+template<typename T, typename Pipeline, typename MakeCollector, typename Merge>
+void collect_chunks(parallel_streamer_t<T, Pipeline> &p, MakeCollector make, Merge merge) {
+    using Collector = decltype(make());
+
+    std::vector<padded<std::optional<Collector> > > partials(p.chunk_total());
+    p.for_each_chunk([&](std::size_t c, auto src) {
+        Collector out(make());
+        while(auto value = src.get()) {
+            if(!out.on_next(*std::move(value)))
+                break;
+        }
+        partials[c].value.emplace(std::move(out));
+    });
+
+    for(auto &partial : partials)
+        merge(*partial.value);
+}
+
+
+template<typename BiFunc, typename I, typename Combine>
+class parallel_fold_t : public step_wrapper<parallel_fold_t<BiFunc, I, Combine> > {
+public:
+    parallel_fold_t(BiFunc &&f, I &&init_value, Combine &&c, thread_pool *tp, std::size_t n)
+        : func(std::move(f)), init(std::move(init_value)), combine(std::move(c)), pool(tp), threads(n) {}
+
+    template<typename T>
+    auto stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use parallel_fold on an unbounded stream");
+
+        return run(parallel_streamer_t<T, parallel_identity>(
+            make_indexable(s), parallel_identity(), pool, threads, true));
+    }
+
+    template<typename T, typename Pipeline>
+    auto run(parallel_streamer_t<T, Pipeline> &&p) {
+        using U = typename parallel_streamer_t<T, Pipeline>::value_type;
+        using R = typename remove_ref_cv<decltype(func(std::move(init), std::declval<U>()))>::type;
+
+        std::vector<padded<std::optional<R> > > partials(p.chunk_total());
+        p.for_each_chunk([&](std::size_t c, auto src) {
+            R acc(init);
+            while(auto value = src.get())
+                acc = func(std::move(acc), *std::move(value));
+            partials[c].value.emplace(std::move(acc));
+        });
+
+        return *combine_tree(partials, combine);
+    }
+
+private:
+    BiFunc func;
+    I init;
+    Combine combine;
+    thread_pool *pool;
+    std::size_t threads;
+};
+
+
+template<typename BiFunc>
+class parallel_reduce_t : public step_wrapper<parallel_reduce_t<BiFunc> > {
+public:
+    parallel_reduce_t(BiFunc &&f, thread_pool *tp, std::size_t n) : func(std::move(f)), pool(tp), threads(n) {}
+
+    template<typename T>
+    auto stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use parallel_reduce on an unbounded stream");
+
+        return run(parallel_streamer_t<T, parallel_identity>(
+            make_indexable(s), parallel_identity(), pool, threads, true));
+    }
+
+    template<typename T, typename Pipeline>
+    auto run(parallel_streamer_t<T, Pipeline> &&p) {
+        using U = typename parallel_streamer_t<T, Pipeline>::value_type;
+        using R = typename remove_ref_cv<decltype(func(std::declval<U>(), std::declval<U>()))>::type;
+
+        std::vector<padded<std::optional<R> > > partials(p.chunk_total());
+        p.for_each_chunk([&](std::size_t c, auto src) {
+            std::optional<R> acc;
+            while(auto value = src.get()) {
+                if(acc)
+                    acc = func(*std::move(acc), *std::move(value));
+                else
+                    acc.emplace(*std::move(value));
+            }
+            partials[c].value = std::move(acc);
+        });
+
+        return combine_tree(partials, func);
+    }
+
+private:
+    BiFunc func;
+    thread_pool *pool;
+    std::size_t threads;
+};
+
+
+// steps which consume a parallel_streamer_t through run(), keeping the whole job on the threads
+template<typename Step>
+struct parallel_terminal : std::false_type {};
+
+template<typename BiFunc, typename I, typename Combine>
+struct parallel_terminal<parallel_fold_t<BiFunc, I, Combine> > : std::true_type {};
+
+template<typename BiFunc>
+struct parallel_terminal<parallel_reduce_t<BiFunc> > : std::true_type {};
+
+
+
+// which of shards a key with hash h belongs to. the hash is mixed first, as std::hash
+// is the identity for integers.
+inline std::size_t shard_of(std::size_t h, std::size_t shards) noexcept {
+    std::uint64_t x = static_cast<std::uint64_t>(h) * 0x9e3779b97f4a7c15ull;
+    return static_cast<std::size_t>((x >> 32) % shards);
+}
+
+
+// moves the nodes of the ordered maps in shards, whose keys are all different, into a
+// single map. as the nodes arrive in order, each insert is at the end of the result.
+template<typename Map>
+Map merge_shards(std::vector<std::optional<Map> > &shards) {
+    Map out(shards.front()->key_comp());
+    auto comp = out.key_comp();
+
+    // a min-heap of the shards by their first key
+    auto later = [&](std::size_t a, std::size_t b) {
+        return comp(shards[b]->begin()->first, shards[a]->begin()->first);
+    };
+    std::vector<std::size_t> heap;
+    for(std::size_t i = 0; i < shards.size(); i++) {
+        if(!shards[i]->empty())
+            heap.push_back(i);
+    }
+    std::make_heap(heap.begin(), heap.end(), later);
+
+    while(!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        Map &shard = *shards[heap.back()];
+        auto node = shard.extract(shard.begin());
+        out.insert(out.end(), std::move(node));
+        if(node)
+            throw std::logic_error("equal keys were collected in different shards");
+        if(shard.empty())
+            heap.pop_back();
+        else
+            std::push_heap(heap.begin(), heap.end(), later);
+    }
+    return out;
+}
+
+
+// whether Map keeps its keys in order, so that shards of it can be merged by key
+template<typename Map, typename = void>
+struct keeps_order : std::false_type {};
+
+template<typename Map>
+struct keeps_order<Map, std::void_t<typename Map::key_compare> > : std::true_type {};
+
+
+// whether keys which Map takes to be equal always have the same std::hash, and so meet
+// in the same shard. a user's comparator may order keys in its own way (ignoring case,
+// say), so only std::less is relied on.
+template<typename Map, typename = void>
+struct shardable_by_hash : std::true_type {};
+
+template<typename Map>
+struct shardable_by_hash<Map, std::void_t<typename Map::key_compare> >
+    : std::bool_constant<std::is_same<typename Map::key_compare, std::less<typename Map::key_type> >::value
+                         || std::is_same<typename Map::key_compare, std::less<> >::value> {};
+
+
+// joins maps whose keys are all different into one. hash maps are simply moved into the
+// first one. the maps are held in std::optional, as Map need not be default constructible.
+template<typename Map>
+Map join_shards(std::vector<std::optional<Map> > &shards) {
+    if constexpr(keeps_order<Map>::value) {
+        return merge_shards(shards);
+    } else {
+        std::size_t total = 0;
+        for(const std::optional<Map> &shard : shards)
+            total += shard->size();
+
+        Map out(*std::move(shards.front()));
+        out.reserve(total);
+        for(std::size_t i = 1; i < shards.size(); i++) {
+            for(auto &entry : *shards[i]) {
+                if(!out.try_emplace(entry.first, std::move(entry.second)).second)
+                    throw std::logic_error("equal keys were collected in different shards");
+            }
+            shards[i].reset();
+        }
+        return out;
+    }
+}
+
+
+// builds the result of a keyed collector (as_map, as_multimap, as_grouping, group_reduce)
+// in three passes: the chunks sort their elements by the hash of their key into one bucket
+// per shard, each shard collects its buckets in chunk order into a map of its own, and the
+// shard maps are joined. elements with equal keys meet in the same shard in their original
+// order, so duplicate keys are handled exactly as by the sequential collector.
+template<typename Step, typename T, typename Pipeline>
+auto hash_sharded_collect(Step &step, parallel_streamer_t<T, Pipeline> &&p) {
+    using U = typename parallel_streamer_t<T, Pipeline>::value_type;
+    using Collector = decltype(step.template collector<U>());
+    using K = typename Collector::K;
+
+    const Collector proto = step.template collector<U>();
+    std::size_t shards = p.thread_count();
+    std::vector<std::vector<std::vector<U> > > buckets(p.chunk_total(), std::vector<std::vector<U> >(shards));
+
+    p.for_each_chunk([&](std::size_t c, auto src) {
+        Collector keys = proto;
+        std::hash<K> hash;
+        std::vector<std::vector<U> > &out = buckets[c];
+        while(auto value = src.get()) {
+            std::size_t h = hash(keys.key(*value));
+            out[shard_of(h, shards)].push_back(*std::move(value));
+        }
+    });
+
+    std::vector<std::optional<decltype(std::declval<Collector&>().result())> > results(shards);
+    p.for_each_task(shards, [&](std::size_t shard) {
+        Collector col = proto;
+        for(auto &chunk : buckets) {
+            std::vector<U> &bucket = chunk[shard];
+            col.on_batch(bucket.data(), bucket.size());
+            std::vector<U>().swap(bucket);
+        }
+        results[shard].emplace(col.result());
+    });
+
+    return join_shards(results);
+}
+
+
+// keys without a std::hash, or compared by a comparator of the user's, are collected on
+// the calling thread
+template<typename Step, typename T, typename Pipeline>
+auto sharded_collect(Step &step, parallel_streamer_t<T, Pipeline> &&p) {
+    using U = typename parallel_streamer_t<T, Pipeline>::value_type;
+    using Collector = decltype(step.template collector<U>());
+    using K = typename Collector::K;
+    using Map = decltype(std::declval<Collector&>().result());
+
+    if constexpr(std::is_default_constructible<std::hash<K> >::value && shardable_by_hash<Map>::value)
+        return hash_sharded_collect(step, std::move(p));
+    else
+        return std::move(p).run() >> step;
+}
+
+
+template<typename Step>
+struct sharded_collectable : std::false_type {};
+
+template<typename KeyFunc, typename ValueFunc, typename Comp>
+struct sharded_collectable<as_map_t<KeyFunc, ValueFunc, Comp> > : std::true_type {};
+
+template<typename KeyFunc, typename ValueFunc>
+struct sharded_collectable<as_map_less_t<KeyFunc, ValueFunc> > : std::true_type {};
+
+template<typename KeyFunc>
+struct sharded_collectable<as_map_identity_t<KeyFunc> > : std::true_type {};
+
+template<typename KeyFunc, typename ValueFunc, typename Comp>
+struct sharded_collectable<as_multimap_t<KeyFunc, ValueFunc, Comp> > : std::true_type {};
+
+template<typename KeyFunc, typename ValueFunc>
+struct sharded_collectable<as_multimap_less_t<KeyFunc, ValueFunc> > : std::true_type {};
+
+template<typename KeyFunc>
+struct sharded_collectable<as_multimap_identity_t<KeyFunc> > : std::true_type {};
+
+template<typename KeyFunc, typename ValueFunc, typename Comp>
+struct sharded_collectable<as_grouping_t<KeyFunc, ValueFunc, Comp> > : std::true_type {};
+
+template<typename KeyFunc, typename ValueFunc>
+struct sharded_collectable<as_grouping_less_t<KeyFunc, ValueFunc> > : std::true_type {};
+
+template<typename KeyFunc>
+struct sharded_collectable<as_grouping_identity_t<KeyFunc> > : std::true_type {};
+
+
+} // namespace detail
+
+
+
+template<typename BiFunc, typename T, typename Combine>
+auto parallel_fold(BiFunc func, T init, Combine combine, std::size_t threads = detail::default_threads()) {
+    return detail::parallel_fold_t<BiFunc, T, Combine>(
+        std::move(func), std::move(init), std::move(combine), nullptr, threads > 0 ? threads : 1);
+}
+
+template<typename BiFunc, typename T, typename Combine>
+auto parallel_fold(BiFunc func, T init, Combine combine, thread_pool &pool) {
+    return detail::parallel_fold_t<BiFunc, T, Combine>(
+        std::move(func), std::move(init), std::move(combine), &pool, pool.size());
+}
+
+template<typename BiFunc>
+auto parallel_reduce(BiFunc func, std::size_t threads = detail::default_threads()) {
+    return detail::parallel_reduce_t<BiFunc>(std::move(func), nullptr, threads > 0 ? threads : 1);
+}
+
+template<typename BiFunc>
+auto parallel_reduce(BiFunc func, thread_pool &pool) {
+    return detail::parallel_reduce_t<BiFunc>(std::move(func), &pool, pool.size());
+}
+
+
+
+namespace detail {
+
+
+// found through ADL, as the steps after parallel need not come from namespace streamer
+template<typename T, typename Pipeline, typename Step>
+auto operator>>(parallel_streamer_t<T, Pipeline> &&p, step_wrapper<Step> &step) {
+    if constexpr(parallel_safe<Step>::value)
+        return std::move(p).then(std::move(step.get_derived()));
+    else if constexpr(parallel_terminal<Step>::value)
+        return step.get_derived().run(std::move(p));
+    else if constexpr(sharded_collectable<Step>::value)
+        return sharded_collect(step.get_derived(), std::move(p));
+    else
+        return std::move(p).run() >> step;
+}
+
+template<typename T, typename Pipeline, typename Step>
+auto operator>>(parallel_streamer_t<T, Pipeline> &&p, step_wrapper<Step> &&step) {
+    return std::move(p) >> step;
+}
+
+
+} // namespace detail
+
+
+} // namespace streamer
+
+#endif
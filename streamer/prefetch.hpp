@@ -0,0 +1,361 @@
+#ifndef STREAMER_PREFETCH_HPP
+#define STREAMER_PREFETCH_HPP
+
+#include "base.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#define STREAMER_PIN_THREADS 1
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+// a bounded queue between one producer thread and one consumer thread. the elements
+// are passed without locking. a thread only takes the mutex to sleep when the ring is
+// full or empty, and the other thread only takes it to wake a sleeping thread.
+template<typename T>
+class spsc_ring {
+public:
+    explicit spsc_ring(std::size_t capacity)
+        : slots(round_up(capacity)), mask(slots.size() - 1), head(), tail(), closed(false),
+          cancelled(false), producer_waiting(false), consumer_waiting(false), error() {
+        head.value = 0;
+        tail.value = 0;
+    }
+
+    spsc_ring(const spsc_ring &) = delete;
+    spsc_ring &operator=(const spsc_ring &) = delete;
+
+    std::size_t capacity() const noexcept { return slots.size(); }
+
+    // producer: moves the n values in, waiting for room as needed. returns false if the
+    // consumer has cancelled, in which case some of them may not have been moved.
+    bool push(T *values, std::size_t n) {
+        while(n > 0) {
+            std::size_t t = tail.value.load(std::memory_order_relaxed);
+            std::size_t room = slots.size() - (t - head.value.load());
+            if(room == 0) {
+                wait(producer_waiting, not_full, [&]() {
+                    return cancelled.load() || tail.value.load(std::memory_order_relaxed) - head.value.load() < slots.size();
+                });
+                if(cancelled.load())
+                    return false;
+                continue;
+            }
+
+            std::size_t count = std::min(room, n);
+            for(std::size_t i = 0; i < count; i++)
+                slots[(t + i) & mask].emplace(std::move(values[i]));
+            tail.value.store(t + count);
+            wake(consumer_waiting, not_empty);
+
+            values += count;
+            n -= count;
+        }
+        return !cancelled.load();
+    }
+
+    // producer: no more elements will be pushed. error, if any, is rethrown to the
+    // consumer once it has taken the elements before it.
+    void close(std::exception_ptr e = nullptr) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = e;
+            closed.store(true);
+        }
+        not_empty.notify_one();
+    }
+
+    bool is_cancelled() const noexcept { return cancelled.load(); }
+
+    // consumer: moves up to n elements into out, waiting until there is at least one.
+    // returns 0 only once the producer has closed the ring and it is empty, rethrowing
+    // the producer's exception the first time.
+    template<typename Out>
+    std::size_t pop(Out *out, std::size_t n) {
+        for(;;) {
+            std::size_t h = head.value.load(std::memory_order_relaxed);
+            std::size_t count = std::min(tail.value.load() - h, n);
+            if(count > 0) {
+                for(std::size_t i = 0; i < count; i++) {
+                    std::optional<T> &slot = slots[(h + i) & mask];
+                    if constexpr(std::is_same<Out, std::optional<T> >::value)
+                        out[i].emplace(*std::move(slot));
+                    else
+                        out[i] = *std::move(slot);
+                    slot.reset();
+                }
+                head.value.store(h + count);
+                wake(producer_waiting, not_full);
+                return count;
+            }
+
+            if(closed.load()) {
+                // the producer may have pushed more just before closing
+                if(tail.value.load() != h)
+                    continue;
+
+                std::exception_ptr e;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    std::swap(e, error);
+                }
+                if(e)
+                    std::rethrow_exception(e);
+                return 0;
+            }
+
+            wait(consumer_waiting, not_empty, [&]() {
+                return closed.load() || tail.value.load() != head.value.load(std::memory_order_relaxed);
+            });
+        }
+    }
+
+    // consumer: no more elements will be popped, and a waiting producer gives up
+    void cancel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            cancelled.store(true);
+        }
+        not_full.notify_one();
+    }
+
+private:
+    static std::size_t round_up(std::size_t n) {
+        if(n == 0)
+            throw std::invalid_argument("the capacity of a prefetch must be at least 1");
+        std::size_t p = 1;
+        while(p < n)
+            p *= 2;
+        return p;
+    }
+
+    // spins briefly before sleeping. the flag is set before ready() is checked again
+    // under the lock, and the other thread reads it after publishing its change, so
+    // one of the two always sees the other.
+    template<typename Ready>
+    void wait(std::atomic<bool> &waiting, std::condition_variable &cv, Ready ready) {
+        for(int spin = 0; spin < 64; spin++) {
+            if(ready())
+                return;
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        waiting.store(true);
+        cv.wait(lock, ready);
+        waiting.store(false);
+    }
+
+    void wake(std::atomic<bool> &waiting, std::condition_variable &cv) {
+        if(waiting.load()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            cv.notify_one();
+        }
+    }
+
+    std::vector<std::optional<T> > slots;
+    std::size_t mask;
+    padded<std::atomic<std::size_t> > head;
+    padded<std::atomic<std::size_t> > tail;
+    std::atomic<bool> closed;
+    std::atomic<bool> cancelled;
+    std::atomic<bool> producer_waiting;
+    std::atomic<bool> consumer_waiting;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+    std::exception_ptr error;
+};
+
+
+// keeps t on the given cpu. this is only a hint: nothing is done for a negative cpu, on
+// other systems than linux, or if the cpu does not exist.
+inline void pin_thread(std::thread &t, int cpu) noexcept {
+#ifdef STREAMER_PIN_THREADS
+    if(cpu < 0 || cpu >= CPU_SETSIZE)
+        return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#else
+    (void)t;
+    (void)cpu;
+#endif
+}
+
+
+// pulls the elements of next_step on a thread of its own into a ring, from which they
+// are handed out. the thread is started by the first pull, and is stopped and joined
+// when the step is destroyed. both threads move the elements a chunk at a time, so the
+// ring's counters are touched once per chunk rather than once per element.
+template<typename T>
+class prefetch_step : public step<T> {
+public:
+    prefetch_step(std::size_t capacity, int cpu, std::unique_ptr<step<T> > &&next)
+        : ring(capacity), next_step(std::move(next)), producer(), pinned(cpu), most(static_cast<std::size_t>(-1)),
+          started(false), taken(0), initial(), pending(), first(0), last(0) {}
+
+    ~prefetch_step() override {
+        if(started) {
+            ring.cancel();
+            producer.join();
+        }
+    }
+
+    std::optional<T> get() override {
+        start();
+        if(first == last) {
+            first = 0;
+            last = ring.pop(pending.data(), pending.size());
+            if(last == 0)
+                return {};
+        }
+        taken++;
+        return std::move(pending[first++]);
+    }
+
+    std::size_t get_batch(T *out, std::size_t n) override {
+        if constexpr(batchable<T>::value) {
+            start();
+            std::size_t count = 0;
+            for(; count < n && first < last; count++)
+                out[count] = *std::move(pending[first++]);
+
+            while(count < n) {
+                std::size_t popped = ring.pop(out + count, n - count);
+                if(popped == 0)
+                    break;
+                count += popped;
+            }
+            taken += count;
+            return count;
+        } else {
+            return step<T>::get_batch(out, n);
+        }
+    }
+
+    size_hint hint() const override {
+        return started ? initial.skipped(taken) : next_step->hint();
+    }
+
+    // the thread stops after n elements, rather than filling the ring with ones which
+    // will never be taken
+    void limit(std::size_t n) override {
+        most = std::min(most, n);
+        next_step->limit(n);
+    }
+
+private:
+    void start() {
+        if(started)
+            return;
+        initial = next_step->hint();
+        pending.resize(chunk());
+        producer = std::thread([this]() { produce(); });
+        pin_thread(producer, pinned);
+        started = true;
+    }
+
+    // a quarter of the ring, so that the consumer can start on one chunk while the next
+    // is being made
+    std::size_t chunk() const noexcept {
+        return std::max<std::size_t>(1, std::min(batch_size, ring.capacity() / 4));
+    }
+
+    void produce() {
+        try {
+            std::size_t left = most;
+            if constexpr(batchable<T>::value) {
+                std::vector<T> buffer(chunk());
+                while(left > 0 && !ring.is_cancelled()) {
+                    std::size_t wanted = std::min(buffer.size(), left);
+                    std::size_t count = next_step->get_batch(buffer.data(), wanted);
+                    left -= count;
+                    if(!ring.push(buffer.data(), count) || count < wanted)
+                        break;
+                }
+            } else {
+                std::vector<T> buffer;
+                buffer.reserve(chunk());
+                bool more = true;
+                while(more && left > 0 && !ring.is_cancelled()) {
+                    while(buffer.size() < buffer.capacity() && left > 0) {
+                        std::optional<T> value = next_step->get();
+                        if(!value) {
+                            more = false;
+                            break;
+                        }
+                        buffer.push_back(*std::move(value));
+                        left--;
+                    }
+                    if(!ring.push(buffer.data(), buffer.size()))
+                        break;
+                    buffer.clear();
+                }
+            }
+            ring.close();
+        } catch(...) {
+            ring.close(std::current_exception());
+        }
+    }
+
+    spsc_ring<T> ring;
+    std::unique_ptr<step<T> > next_step;
+    std::thread producer;
+    int pinned;
+    std::size_t most;
+    bool started;
+    std::size_t taken;
+    size_hint initial;
+    std::vector<std::optional<T> > pending;
+    std::size_t first;
+    std::size_t last;
+};
+
+
+} // namespace detail
+
+
+
+// pulls the elements before it on a thread of its own, up to capacity of them ahead of
+// the steps after it, so that an expensive source or mapping overlaps with the rest of
+// the stream. an exception thrown before the prefetch is rethrown after it, once the
+// elements before it have been taken. the thread stops when the stream is destroyed,
+// even if not all of it was used.
+class prefetch : public detail::step_wrapper<prefetch> {
+public:
+    explicit prefetch(std::size_t capacity = 1024) : cap(capacity) {
+        if(cap == 0)
+            throw std::invalid_argument("the capacity of a prefetch must be at least 1");
+    }
+
+    template<typename T>
+    streamer_t<T> &&stream(streamer_t<T> &st, std::unique_ptr<detail::step<T> > &s, bool &) {
+        s.reset(new detail::prefetch_step<T>(cap, -1, std::move(s)));
+        return std::move(st);
+    }
+
+private:
+    std::size_t cap;
+};
+
+
+} // namespace streamer
+
+#endif
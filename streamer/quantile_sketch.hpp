@@ -0,0 +1,298 @@
+#ifndef STREAMER_QUANTILE_SKETCH_HPP
+#define STREAMER_QUANTILE_SKETCH_HPP
+
+#include "base.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+namespace streamer {
+
+
+// a KLL sketch: approximate quantiles of any number of elements in a fixed amount of
+// memory. elements are kept in levels, where an element of level h stands for 2^h of the
+// elements inserted. when the levels are full, the lowest full one is sorted and every other
+// element of it is moved up a level, starting from the first or second at random.
+//
+// accuracy is the rank error aimed for: with 0.01, quantile(0.5) is usually the element
+// at a rank between 49% and 51%. memory grows with 1 / accuracy, not with the number of
+// elements. sketches built with the same accuracy can be merged, so parts of a stream
+// can be sketched separately. the smallest and largest elements are kept exactly.
+template<typename T, typename Comp = std::less<T> >
+class kll_sketch {
+public:
+    using value_type = T;
+
+    explicit kll_sketch(double accuracy = 0.01, const Comp &c = Comp())
+        : k(capacity_for(accuracy)), comp(c), levels(), caps(), total_cap(0), n(0), held(0),
+          bits(0x9e3779b97f4a7c15ull), lo(), hi() { add_levels(1); }
+
+    void insert(const T &value) { insert(T(value)); }
+
+    void insert(T &&value) {
+        if(!lo || comp(value, *lo))
+            lo = value;
+        if(!hi || comp(*hi, value))
+            hi = value;
+
+        levels[0].push_back(std::move(value));
+        n++;
+        held++;
+        while(held > total_cap)
+            compress();
+    }
+
+    void merge(const kll_sketch &other) {
+        if(other.n == 0)
+            return;
+        if(&other == this) {
+            kll_sketch copy(other);
+            merge(copy);
+            return;
+        }
+
+        if(levels.size() < other.levels.size())
+            add_levels(other.levels.size() - levels.size());
+        for(std::size_t h = 0; h < other.levels.size(); h++)
+            levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+
+        if(!lo || comp(*other.lo, *lo))
+            lo = other.lo;
+        if(!hi || comp(*hi, *other.hi))
+            hi = other.hi;
+
+        n += other.n;
+        held += other.held;
+        while(held > total_cap)
+            compress();
+    }
+
+    // the number of elements inserted
+    std::uint64_t size() const noexcept { return n; }
+    bool empty() const noexcept { return n == 0; }
+
+    // the number of elements kept
+    std::size_t retained() const noexcept { return held; }
+
+    // the element at about fraction q of the way through the sorted elements, or an empty
+    // std::optional if there are none. 0 and 1 give the exact smallest and largest.
+    std::optional<T> quantile(double q) const {
+        std::vector<T> found = quantiles({q});
+        if(found.empty())
+            return {};
+        return {std::move(found[0])};
+    }
+
+    // quantile(q) for each q, sorting the kept elements only once
+    std::vector<T> quantiles(const std::vector<double> &qs) const {
+        for(double q : qs) {
+            if(!(q >= 0.0 && q <= 1.0))
+                throw std::invalid_argument("quantiles must be between 0 and 1");
+        }
+        if(n == 0)
+            return {};
+
+        auto items = weighted();
+        std::vector<T> out;
+        out.reserve(qs.size());
+        for(double q : qs) {
+            if(q == 0.0) {
+                out.push_back(*lo);
+            } else if(q == 1.0) {
+                out.push_back(*hi);
+            } else {
+                auto rank = static_cast<std::uint64_t>(q * static_cast<double>(n - 1));
+                auto it = std::upper_bound(items.begin(), items.end(), rank,
+                    [](std::uint64_t r, const std::pair<const T*, std::uint64_t> &item) { return r < item.second; });
+                out.push_back(it != items.end() ? *it->first : *hi);
+            }
+        }
+        return out;
+    }
+
+    // about the fraction of the elements which are less than value
+    double rank(const T &value) const {
+        if(n == 0)
+            return 0.0;
+
+        std::uint64_t below = 0;
+        for(std::size_t h = 0; h < levels.size(); h++) {
+            for(const T &item : levels[h]) {
+                if(comp(item, value))
+                    below += std::uint64_t(1) << h;
+            }
+        }
+        return static_cast<double>(below) / static_cast<double>(n);
+    }
+
+private:
+    static std::size_t capacity_for(double accuracy) {
+        if(!(accuracy > 0.0 && accuracy < 1.0))
+            throw std::invalid_argument("kll_sketch accuracy must be between 0 and 1");
+        return std::max<std::size_t>(8, static_cast<std::size_t>(std::ceil(2.0 / accuracy)));
+    }
+
+    // the top level holds k elements and each one below it 2/3 as many, down to a
+    // minimum of 2, so the capacities change whenever a level is added
+    void add_levels(std::size_t count) {
+        levels.resize(levels.size() + count);
+        caps.resize(levels.size());
+        total_cap = 0;
+        for(std::size_t h = 0; h < levels.size(); h++) {
+            double depth = static_cast<double>(levels.size() - 1 - h);
+            auto cap = static_cast<std::size_t>(std::ceil(static_cast<double>(k) * std::pow(2.0 / 3.0, depth)));
+            caps[h] = std::max<std::size_t>(2, cap);
+            total_cap += caps[h];
+        }
+    }
+
+    // compacts the lowest full level. there always is one while held > total_cap.
+    void compress() {
+        for(std::size_t h = 0; h < levels.size(); h++) {
+            if(levels[h].size() >= caps[h]) {
+                compact(h);
+                return;
+            }
+        }
+    }
+
+    void compact(std::size_t h) {
+        if(h + 1 == levels.size())
+            add_levels(1);
+
+        std::vector<T> &level = levels[h];
+        std::vector<T> &next = levels[h + 1];
+        std::sort(level.begin(), level.end(), comp);
+
+        // an odd element out stays where it is
+        std::size_t paired = level.size() - level.size() % 2;
+        for(std::size_t i = random_bit(); i < paired; i += 2)
+            next.push_back(std::move(level[i]));
+
+        level.erase(level.begin(), level.begin() + static_cast<std::ptrdiff_t>(paired));
+        held -= paired / 2;
+    }
+
+    std::size_t random_bit() noexcept {
+        bits ^= bits << 13;
+        bits ^= bits >> 7;
+        bits ^= bits << 17;
+        return static_cast<std::size_t>(bits & 1);
+    }
+
+    // the kept elements in order, each with the total weight of the elements up to and
+    // including it
+    std::vector<std::pair<const T*, std::uint64_t> > weighted() const {
+        std::vector<std::pair<const T*, std::uint64_t> > items;
+        items.reserve(held);
+        for(std::size_t h = 0; h < levels.size(); h++) {
+            for(const T &item : levels[h])
+                items.emplace_back(&item, std::uint64_t(1) << h);
+        }
+
+        std::sort(items.begin(), items.end(), [this](const auto &a, const auto &b) { return comp(*a.first, *b.first); });
+        std::uint64_t total = 0;
+        for(auto &item : items) {
+            total += item.second;
+            item.second = total;
+        }
+        return items;
+    }
+
+    std::size_t k;
+    Comp comp;
+    std::vector<std::vector<T> > levels;
+    std::vector<std::size_t> caps;
+    std::size_t total_cap;
+    std::uint64_t n;
+    std::size_t held;
+    std::uint64_t bits;
+    std::optional<T> lo;
+    std::optional<T> hi;
+};
+
+
+
+namespace detail {
+
+
+template<typename T>
+class quantile_sketch_collector : public collector_sink<quantile_sketch_collector<T>, T> {
+public:
+    quantile_sketch_collector(double accuracy) : out(accuracy) {}
+
+    bool on_next(T &&value) override {
+        out.insert(std::move(value));
+        return true;
+    }
+
+    kll_sketch<T> result() { return std::move(out); }
+
+private:
+    kll_sketch<T> out;
+};
+
+
+class quantile_sketch_t : public step_wrapper<quantile_sketch_t> {
+public:
+    quantile_sketch_t(double acc) : accuracy(acc) {
+        if(!(accuracy > 0.0 && accuracy < 1.0))
+            throw std::invalid_argument("kll_sketch accuracy must be between 0 and 1");
+    }
+
+    template<typename T>
+    kll_sketch<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use quantile_sketch on an unbounded stream");
+
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    quantile_sketch_collector<T> collector() { return quantile_sketch_collector<T>(accuracy); }
+
+    // each chunk is sketched on its own thread, then the sketches are merged in the
+    // order of the chunks
+    template<typename T, typename Pipeline>
+    auto run(parallel_streamer_t<T, Pipeline> &&p) {
+        using U = typename parallel_streamer_t<T, Pipeline>::value_type;
+
+        kll_sketch<U> merged(accuracy);
+        auto make = [this]() { return collector<U>(); };
+        collect_chunks(p, make, [&merged](quantile_sketch_collector<U> &partial) {
+            merged.merge(partial.result());
+        });
+        return merged;
+    }
+
+private:
+    double accuracy;
+};
+
+
+template<>
+struct parallel_terminal<quantile_sketch_t> : std::true_type {};
+
+
+}  // namespace detail
+
+
+
+// a kll_sketch of the elements of the stream
+inline auto quantile_sketch(double accuracy = 0.01) {
+    return detail::quantile_sketch_t(accuracy);
+}
+
+
+} // namespace streamer
+
+#endif
@@ -2,6 +2,7 @@
 #define STREAMER_QUEUE_HPP
 
 #include "base.hpp"
+#include "deque.hpp"
 #include <deque>
 #include <queue>
 
@@ -17,11 +18,13 @@ public:
     constexpr as_queue_t &operator()() noexcept { return *this; }
 
     template<typename T>
-    std::queue<T> stream(streamer_t<T> &st, std::unique_ptr<step<T> > &, bool &unbounded) {
+    std::queue<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
         if(unbounded)
             throw unbounded_stream("cannot use as_queue on an unbounded stream");
 
-        return std::queue<T>(std::deque<T>(st.begin(), st.end()));
+        deque_collector<T> out;
+        s->push(out);
+        return std::queue<T>(out.result());
     }
 };
 
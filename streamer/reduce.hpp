@@ -2,6 +2,7 @@
 #define STREAMER_REDUCE_HPP
 
 #include "base.hpp"
+#include "simd.hpp"
 
 
 namespace streamer {
@@ -10,6 +11,89 @@ namespace streamer {
 namespace detail {
 
 
+template<typename BiFunc, typename R, typename T>
+class fold_init_collector : public collector_sink<fold_init_collector<BiFunc, R, T>, T> {
+public:
+    fold_init_collector(BiFunc &&f, R &&init) : func(std::move(f)), acc(std::move(init)) {}
+
+    bool on_next(T &&value) override {
+        acc = func(std::move(acc), std::move(value));
+        return true;
+    }
+
+    R result() { return std::move(acc); }
+
+private:
+    BiFunc func;
+    R acc;
+};
+
+
+template<typename BiFunc, typename R, typename T>
+class fold_collector : public collector_sink<fold_collector<BiFunc, R, T>, T> {
+public:
+    fold_collector(BiFunc &&f) : func(std::move(f)), acc() {}
+
+    bool on_next(T &&value) override {
+        if(acc)
+            acc = func(*std::move(acc), std::move(value));
+        else
+            acc.emplace(std::move(value));
+        return true;
+    }
+
+    std::optional<R> result() { return std::move(acc); }
+
+private:
+    BiFunc func;
+    std::optional<R> acc;
+};
+
+
+// arithmetic elements compared with std::less are looked at in batches
+template<typename Comp, typename T>
+struct simd_minimum : std::integral_constant<bool,
+    std::is_arithmetic<T>::value && std::is_same<Comp, std::less<T> >::value> {};
+
+
+template<typename Comp, typename T>
+class minimum_collector : public collector_sink<minimum_collector<Comp, T>, T> {
+public:
+    minimum_collector(Comp &&c) : comp(std::move(c)), min() {}
+
+    bool on_next(T &&value) override {
+        if(!min || comp(value, *min))
+            min = std::move(value);
+        return true;
+    }
+
+    bool on_batch(T *values, std::size_t n) override {
+        if constexpr(simd_minimum<Comp, T>::value) {
+            add(values, n);
+            return true;
+        } else {
+            return collector_sink<minimum_collector<Comp, T>, T>::on_batch(values, n);
+        }
+    }
+
+    // only for simd_minimum
+    void add(const T *values, std::size_t n) noexcept {
+        if(n == 0)
+            return;
+        T found = simd_minmax(values, n).first;
+        if(!min || found < *min)
+            min = found;
+    }
+
+    std::optional<T> result() { return std::move(min); }
+
+private:
+    Comp comp;
+    std::optional<T> min;
+};
+
+
+
 template<typename BiFunc, typename T>
 class fold_init_t : public step_wrapper<fold_init_t<BiFunc, T> > {
 public:
@@ -20,14 +104,15 @@ public:
         if(unbounded)
             throw unbounded_stream("cannot use fold(BiFunc, T) on an unbounded stream");
 
-        using R = typename remove_ref_cv<decltype(func(*s->get(), *s->get()))>::type;
-
-        R result = std::move(init);
-
-        while(std::optional<U> value = s->get())
-            result = func(std::move(result), *std::move(value));
+        auto out = collector<U>();
+        s->push(out);
+        return out.result();
+    }
 
-        return result;
+    template<typename U>
+    auto collector() {
+        using R = typename remove_ref_cv<decltype(func(std::move(init), std::declval<U>()))>::type;
+        return fold_init_collector<BiFunc, R, U>(std::move(func), R(std::move(init)));
     }
 
 private:
@@ -37,7 +122,7 @@ private:
 
 
 template<typename BiFunc>
-class fold_t : public step_wrapper<fold<BiFunc> > {
+class fold_t : public step_wrapper<fold_t<BiFunc> > {
 public:
     fold_t(BiFunc &&f) : func(std::move(f)) {}
 
@@ -46,18 +131,15 @@ public:
         if(unbounded)
             throw unbounded_stream("cannot use fold(BiFunc) on an unbounded stream");
 
-        using R = typename remove_ref_cv<decltype(func(*s->get(), *s->get()))>::type;
-
-        std::optional<T> value = s->get();
-        if(!value)
-            return std::optional<R>();
-
-        R result = *std::move(value);
-
-        while((value = s->get()))
-            result = func(std::move(result), *std::move(value));
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
+    }
 
-        return std::optional<R>(std::move(result));
+    template<typename T>
+    auto collector() {
+        using R = typename remove_ref_cv<decltype(func(std::declval<T>(), std::declval<T>()))>::type;
+        return fold_collector<BiFunc, R, T>(std::move(func));
     }
 
 private:
@@ -72,14 +154,18 @@ public:
     minimum_custom_t(Comp &&p) : comp(std::move(p)) {}
 
     template<typename T>
-    auto stream(streamer_t<T> st&, std::unique_ptr<step<T> > &s, bool &unbounded) {
+    std::optional<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
         if(unbounded)
             throw unbounded_stream("cannot use minimum(Comp) on an unbounded stream");
 
-        return fold([this](const auto &x, const auto &y) { return comp(y, x) ? y : x; })
-            .stream(st, s, unbounded);
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
     }
 
+    template<typename T>
+    minimum_collector<Comp, T> collector() { return minimum_collector<Comp, T>(std::move(comp)); }
+
 private:
     Comp comp;
 };
@@ -100,12 +186,18 @@ public:
     }
 
     template<typename T>
-    std::optional<T> stream(streamer_t<T> st&, std::unique_ptr<step<T> > &s, bool &unbounded) {
+    std::optional<T> stream(streamer_t<T> &st, std::unique_ptr<step<T> > &s, bool &unbounded) {
         if(unbounded)
             throw unbounded_stream("cannot use minimum on an unbounded stream");
 
-        return minimum_custom_t<std::less<T> >(std::less<T>()).stream(st, s, unbounded);
+        if constexpr(std::is_arithmetic<T>::value)
+            return collect_numeric(*s, collector<T>());
+        else
+            return minimum_custom_t<std::less<T> >(std::less<T>()).stream(st, s, unbounded);
     }
+
+    template<typename T>
+    minimum_collector<std::less<T>, T> collector() { return minimum_collector<std::less<T>, T>(std::less<T>()); }
 };
 
 
@@ -118,7 +210,7 @@ auto fold(BiFunc func, T init) {
 }
 
 template<typename BiFunc>
-auto fold(Bifunc func) {
+auto fold(BiFunc func) {
     return detail::fold_t<BiFunc>(std::move(func));
 }
 
@@ -19,6 +19,25 @@ public:
 namespace detail {
 
     
+template<typename Comp, typename T>
+class set_collector : public collector_sink<set_collector<Comp, T>, T> {
+public:
+    set_collector(Comp &&c, bool throw_on_dup) : out(std::move(c)), dup_throw(throw_on_dup) {}
+
+    bool on_next(T &&value) override {
+        if(!out.insert(std::move(value)).second && dup_throw)
+            throw duplicate_set_key("value already exists in set");
+        return true;
+    }
+
+    std::set<T, Comp> result() { return std::move(out); }
+
+private:
+    std::set<T, Comp> out;
+    bool dup_throw;
+};
+
+
 template<typename Comp>
 class as_set_custom_t : public step_wrapper<as_set_custom_t<Comp> > {
 public:
@@ -26,23 +45,18 @@ public:
         : comp(std::move(c)), dup_throw(throw_on_dup) {}
 
     template<typename T>
-    std::set<T, Comp> stream(streamer_t<T> &st, std::unique_ptr<step<T> > &s, bool &unbounded) {
+    std::set<T, Comp> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
         if(unbounded)
             throw unbounded_stream("cannot use as_set on an unbounded stream");
 
-        if(!dup_throw)
-            return std::set<T, Comp>(st.begin(), st.end(), comp);
-
-        std::set<T, Comp> out(comp);
-
-        while(std::optional<T> value = s->get()) {
-            if(!out.insert(*std::move(value)).second)
-                throw duplicate_set_key("value already exists in set");
-        }
-
-        return out;
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
     }
 
+    template<typename T>
+    set_collector<Comp, T> collector() { return set_collector<Comp, T>(std::move(comp), dup_throw); }
+
 private:
     Comp comp;
     bool dup_throw;
@@ -72,25 +86,50 @@ public:
         return as_set_custom_t<std::less<T> >(std::less<T>(), dup_throw).stream(st, s, unbounded);
     }
 
+    template<typename T>
+    set_collector<std::less<T>, T> collector() { return set_collector<std::less<T>, T>(std::less<T>(), dup_throw); }
+
 private:
     bool dup_throw;
 };
 
 
 
+template<typename Comp, typename T>
+class multiset_collector : public collector_sink<multiset_collector<Comp, T>, T> {
+public:
+    multiset_collector(Comp &&c) : out(std::move(c)) {}
+
+    bool on_next(T &&value) override {
+        out.insert(std::move(value));
+        return true;
+    }
+
+    std::multiset<T, Comp> result() { return std::move(out); }
+
+private:
+    std::multiset<T, Comp> out;
+};
+
+
 template<typename Comp>
 class as_multiset_custom_t : public step_wrapper<as_multiset_custom_t<Comp> > {
 public:
     as_multiset_custom_t(Comp &&c) : comp(std::move(c)) {}
 
     template<typename T>
-    std::multiset<T, Comp> stream(streamer_t<T> &st, std::unique_ptr<step<T> > &, bool &unbounded) {
+    std::multiset<T, Comp> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
         if(unbounded)
             throw unbounded_stream("cannot use as_multiset on an unbounded stream");
 
-        return std::multiset<T, Comp>(st.begin(), st.end(), comp);
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
     }
 
+    template<typename T>
+    multiset_collector<Comp, T> collector() { return multiset_collector<Comp, T>(std::move(comp)); }
+
 private:
     Comp comp;
 };
@@ -114,6 +153,9 @@ public:
     std::multiset<T> stream(streamer_t<T> &st, std::unique_ptr<step<T> > &s, bool &unbounded) {
         return as_multiset_custom_t<std::less<T> >(std::less<T>()).stream(st, s, unbounded);
     }
+
+    template<typename T>
+    multiset_collector<std::less<T>, T> collector() { return multiset_collector<std::less<T>, T>(std::less<T>()); }
 };
 
 
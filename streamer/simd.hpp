@@ -0,0 +1,348 @@
+#ifndef STREAMER_SIMD_HPP
+#define STREAMER_SIMD_HPP
+
+#include "base.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define STREAMER_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+// what sum adds T up in: T after integer promotion
+template<typename T>
+using sum_type = decltype(T() + T());
+
+// what mean adds T up in, so that it does not overflow
+template<typename T>
+using wide_sum_type = typename std::conditional<std::is_floating_point<T>::value, double,
+    typename std::conditional<std::is_signed<T>::value, std::int64_t, std::uint64_t>::type>::type;
+
+
+// the scalar kernels keep several accumulators, so that the additions do not wait on
+// each other
+
+template<typename R, typename T>
+R sum_scalar(const T *p, std::size_t n) noexcept {
+    R a0 = R(), a1 = R(), a2 = R(), a3 = R();
+    std::size_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+        a0 += p[i];
+        a1 += p[i + 1];
+        a2 += p[i + 2];
+        a3 += p[i + 3];
+    }
+    for(; i < n; i++)
+        a0 += p[i];
+    return (a0 + a1) + (a2 + a3);
+}
+
+// the smallest and largest of n > 0 elements by operator<. of equal elements, the first
+// is kept, and NaNs after the first element are skipped, as by minimum.
+template<typename T>
+std::pair<T, T> minmax_scalar(const T *p, std::size_t n) noexcept {
+    T lo = p[0];
+    T hi = p[0];
+    for(std::size_t i = 1; i < n; i++) {
+        if(p[i] < lo)
+            lo = p[i];
+        if(hi < p[i])
+            hi = p[i];
+    }
+    return {lo, hi};
+}
+
+
+#ifdef STREAMER_SIMD_X86
+
+inline bool has_avx2() noexcept {
+    static const bool avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+    return avx2;
+}
+
+
+__attribute__((target("avx2"))) inline float sum_avx2(const float *p, std::size_t n) noexcept {
+    __m256 a0 = _mm256_setzero_ps(), a1 = _mm256_setzero_ps(), a2 = _mm256_setzero_ps(), a3 = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for(; i + 32 <= n; i += 32) {
+        a0 = _mm256_add_ps(a0, _mm256_loadu_ps(p + i));
+        a1 = _mm256_add_ps(a1, _mm256_loadu_ps(p + i + 8));
+        a2 = _mm256_add_ps(a2, _mm256_loadu_ps(p + i + 16));
+        a3 = _mm256_add_ps(a3, _mm256_loadu_ps(p + i + 24));
+    }
+    for(; i + 8 <= n; i += 8)
+        a0 = _mm256_add_ps(a0, _mm256_loadu_ps(p + i));
+
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(_mm256_add_ps(a0, a1), _mm256_add_ps(a2, a3)));
+    float sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    for(; i < n; i++)
+        sum += p[i];
+    return sum;
+}
+
+__attribute__((target("avx2"))) inline double sum_avx2(const double *p, std::size_t n) noexcept {
+    __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd(), a2 = _mm256_setzero_pd(), a3 = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16) {
+        a0 = _mm256_add_pd(a0, _mm256_loadu_pd(p + i));
+        a1 = _mm256_add_pd(a1, _mm256_loadu_pd(p + i + 4));
+        a2 = _mm256_add_pd(a2, _mm256_loadu_pd(p + i + 8));
+        a3 = _mm256_add_pd(a3, _mm256_loadu_pd(p + i + 12));
+    }
+    for(; i + 4 <= n; i += 4)
+        a0 = _mm256_add_pd(a0, _mm256_loadu_pd(p + i));
+
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(_mm256_add_pd(a0, a1), _mm256_add_pd(a2, a3)));
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for(; i < n; i++)
+        sum += p[i];
+    return sum;
+}
+
+// 32 and 64-bit integers of either sign are added as unsigned, which wraps around
+// the same way
+__attribute__((target("avx2"))) inline std::uint32_t sum_u32_avx2(const std::uint32_t *p, std::size_t n) noexcept {
+    __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16) {
+        a0 = _mm256_add_epi32(a0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+        a1 = _mm256_add_epi32(a1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 8)));
+    }
+    for(; i + 8 <= n; i += 8)
+        a0 = _mm256_add_epi32(a0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+
+    alignas(32) std::uint32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi32(a0, a1));
+    std::uint32_t sum = 0;
+    for(std::uint32_t lane : lanes)
+        sum += lane;
+    for(; i < n; i++)
+        sum += p[i];
+    return sum;
+}
+
+__attribute__((target("avx2"))) inline std::uint64_t sum_u64_avx2(const std::uint64_t *p, std::size_t n) noexcept {
+    __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+        a0 = _mm256_add_epi64(a0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+        a1 = _mm256_add_epi64(a1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 4)));
+    }
+    for(; i + 4 <= n; i += 4)
+        a0 = _mm256_add_epi64(a0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(a0, a1));
+    std::uint64_t sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for(; i < n; i++)
+        sum += p[i];
+    return sum;
+}
+
+// floats added up as doubles, for mean
+__attribute__((target("avx2"))) inline double wide_sum_avx2(const float *p, std::size_t n) noexcept {
+    __m256d a0 = _mm256_setzero_pd(), a1 = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+        a0 = _mm256_add_pd(a0, _mm256_cvtps_pd(_mm_loadu_ps(p + i)));
+        a1 = _mm256_add_pd(a1, _mm256_cvtps_pd(_mm_loadu_ps(p + i + 4)));
+    }
+
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, _mm256_add_pd(a0, a1));
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for(; i < n; i++)
+        sum += p[i];
+    return sum;
+}
+
+// 32-bit signed integers added up as 64-bit ones, for mean
+__attribute__((target("avx2"))) inline std::int64_t wide_sum_avx2(const std::int32_t *p, std::size_t n) noexcept {
+    __m256i a0 = _mm256_setzero_si256(), a1 = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+        a0 = _mm256_add_epi64(a0, _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i))));
+        a1 = _mm256_add_epi64(a1, _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 4))));
+    }
+
+    alignas(32) std::int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(a0, a1));
+    std::int64_t sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for(; i < n; i++)
+        sum += p[i];
+    return sum;
+}
+
+
+// min(v, acc) gives acc when either is a NaN, so a NaN in v is skipped as long as the
+// accumulators start from a number
+__attribute__((target("avx2"))) inline std::pair<float, float> minmax_avx2(const float *p, std::size_t n) noexcept {
+    __m256 lo = _mm256_set1_ps(p[0]);
+    __m256 hi = lo;
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(p + i);
+        lo = _mm256_min_ps(v, lo);
+        hi = _mm256_max_ps(v, hi);
+    }
+
+    alignas(32) float los[8];
+    alignas(32) float his[8];
+    _mm256_store_ps(los, lo);
+    _mm256_store_ps(his, hi);
+    std::pair<float, float> lanes = {minmax_scalar(los, 8).first, minmax_scalar(his, 8).second};
+    for(; i < n; i++) {
+        if(p[i] < lanes.first)
+            lanes.first = p[i];
+        if(lanes.second < p[i])
+            lanes.second = p[i];
+    }
+    return lanes;
+}
+
+__attribute__((target("avx2"))) inline std::pair<double, double> minmax_avx2(const double *p, std::size_t n) noexcept {
+    __m256d lo = _mm256_set1_pd(p[0]);
+    __m256d hi = lo;
+    std::size_t i = 0;
+    for(; i + 4 <= n; i += 4) {
+        __m256d v = _mm256_loadu_pd(p + i);
+        lo = _mm256_min_pd(v, lo);
+        hi = _mm256_max_pd(v, hi);
+    }
+
+    alignas(32) double los[4];
+    alignas(32) double his[4];
+    _mm256_store_pd(los, lo);
+    _mm256_store_pd(his, hi);
+    std::pair<double, double> lanes = {minmax_scalar(los, 4).first, minmax_scalar(his, 4).second};
+    for(; i < n; i++) {
+        if(p[i] < lanes.first)
+            lanes.first = p[i];
+        if(lanes.second < p[i])
+            lanes.second = p[i];
+    }
+    return lanes;
+}
+
+__attribute__((target("avx2"))) inline std::pair<std::int32_t, std::int32_t> minmax_avx2(const std::int32_t *p, std::size_t n) noexcept {
+    __m256i lo = _mm256_set1_epi32(p[0]);
+    __m256i hi = lo;
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        lo = _mm256_min_epi32(v, lo);
+        hi = _mm256_max_epi32(v, hi);
+    }
+
+    alignas(32) std::int32_t los[8];
+    alignas(32) std::int32_t his[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(los), lo);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(his), hi);
+    std::pair<std::int32_t, std::int32_t> lanes = {minmax_scalar(los, 8).first, minmax_scalar(his, 8).second};
+    for(; i < n; i++) {
+        if(p[i] < lanes.first)
+            lanes.first = p[i];
+        if(lanes.second < p[i])
+            lanes.second = p[i];
+    }
+    return lanes;
+}
+
+#endif
+
+
+// whether T is U or its signed counterpart, which a U* may point to
+template<typename T, typename U, bool = std::is_integral<T>::value && !std::is_same<T, bool>::value>
+struct same_unsigned : std::is_same<typename std::make_unsigned<T>::type, U> {};
+
+template<typename T, typename U>
+struct same_unsigned<T, U, false> : std::false_type {};
+
+
+// the sum of n elements. floating point elements are added in a different order than
+// one after another, so the rounding may differ slightly from that of fold.
+template<typename T>
+sum_type<T> simd_sum(const T *p, std::size_t n) noexcept {
+#ifdef STREAMER_SIMD_X86
+    if(has_avx2()) {
+        if constexpr(std::is_same<T, float>::value || std::is_same<T, double>::value) {
+            return sum_avx2(p, n);
+        } else if constexpr(same_unsigned<T, std::uint32_t>::value) {
+            return static_cast<sum_type<T> >(sum_u32_avx2(reinterpret_cast<const std::uint32_t*>(p), n));
+        } else if constexpr(same_unsigned<T, std::uint64_t>::value) {
+            return static_cast<sum_type<T> >(sum_u64_avx2(reinterpret_cast<const std::uint64_t*>(p), n));
+        }
+    }
+#endif
+    return sum_scalar<sum_type<T> >(p, n);
+}
+
+
+template<typename T>
+wide_sum_type<T> simd_wide_sum(const T *p, std::size_t n) noexcept {
+#ifdef STREAMER_SIMD_X86
+    if(has_avx2()) {
+        if constexpr(std::is_same<T, float>::value || std::is_same<T, std::int32_t>::value) {
+            return wide_sum_avx2(p, n);
+        } else if constexpr(std::is_same<T, wide_sum_type<T> >::value) {
+            return simd_sum(p, n);
+        }
+    }
+#endif
+    return sum_scalar<wide_sum_type<T> >(p, n);
+}
+
+
+// the smallest and largest of n > 0 elements, as minmax_scalar. which of equal elements
+// is returned may differ when they can be told apart, as 0.0 and -0.0 can.
+template<typename T>
+std::pair<T, T> simd_minmax(const T *p, std::size_t n) noexcept {
+#ifdef STREAMER_SIMD_X86
+    if(has_avx2()) {
+        if constexpr(std::is_same<T, float>::value || std::is_same<T, double>::value) {
+            // a NaN first element is left to the scalar loop, which keeps it
+            if(p[0] == p[0])
+                return minmax_avx2(p, n);
+        } else if constexpr(std::is_same<T, std::int32_t>::value) {
+            return minmax_avx2(p, n);
+        }
+    }
+#endif
+    return minmax_scalar(p, n);
+}
+
+
+// passes the remaining elements of s to out.add() straight from memory, if they lie one
+// after another there, and consumes them. otherwise they are pushed into out in batches,
+// which out.on_batch() also passes to out.add().
+template<typename T, typename Collector>
+auto collect_numeric(step<T> &s, Collector &&out) {
+    if(const T *p = s.contiguous()) {
+        std::size_t n = s.hint().size;
+        out.add(p, n);
+        s.discard(n);
+    } else {
+        s.push(out);
+    }
+    return out.result();
+}
+
+
+} // namespace detail
+
+
+} // namespace streamer
+
+#endif
@@ -0,0 +1,572 @@
+#ifndef STREAMER_SORTED_HPP
+#define STREAMER_SORTED_HPP
+
+#include "base.hpp"
+#include "parallel.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+// below this many elements, sorting on one thread is faster than starting others
+constexpr std::size_t parallel_sort_min = std::size_t(1) << 16;
+
+
+// keys which radix_bits maps to unsigned integers in the same order
+template<typename K>
+struct radix_sortable : std::integral_constant<bool,
+    (std::is_integral<K>::value && !std::is_same<K, bool>::value) ||
+    (std::is_same<K, float>::value && std::numeric_limits<float>::is_iec559) ||
+    (std::is_same<K, double>::value && std::numeric_limits<double>::is_iec559)> {};
+
+
+template<typename K>
+auto radix_bits(K key) noexcept {
+    if constexpr(std::is_integral<K>::value) {
+        using U = typename std::make_unsigned<K>::type;
+        U bits = static_cast<U>(key);
+        if constexpr(std::is_signed<K>::value)
+            bits ^= U(1) << (std::numeric_limits<U>::digits - 1);
+        return bits;
+    } else {
+        using U = typename std::conditional<sizeof(K) == 4, std::uint32_t, std::uint64_t>::type;
+        // -0.0 and 0.0 are equal for std::less, so they must have the same bits to keep
+        // their order in the stream
+        if(key == K(0))
+            key = K(0);
+        U bits;
+        std::memcpy(&bits, &key, sizeof(K));
+        // negative numbers are ordered backwards by their bits, positive ones just need
+        // to come after them
+        U sign = U(1) << (std::numeric_limits<U>::digits - 1);
+        return (bits & sign) ? U(~bits) : U(bits | sign);
+    }
+}
+
+
+// whether sorting by Comp is sorting radix_bits ascending (less) or descending (greater)
+template<typename K, typename Comp>
+struct radix_order {
+    static constexpr bool ascending = std::is_same<Comp, std::less<K> >::value
+        || std::is_same<Comp, std::less<> >::value
+        || std::is_same<Comp, default_less>::value;
+    static constexpr bool descending = std::is_same<Comp, std::greater<K> >::value
+        || std::is_same<Comp, std::greater<> >::value;
+    static constexpr bool value = radix_sortable<K>::value && (ascending || descending);
+};
+
+
+// a stable LSD radix sort of (bits, index) pairs by bits, a byte at a time. bytes which
+// are the same for every key are skipped.
+template<typename U>
+void radix_sort(std::vector<std::pair<U, std::size_t> > &v) {
+    std::vector<std::pair<U, std::size_t> > buffer(v.size());
+    std::size_t counts[256];
+
+    for(unsigned shift = 0; shift < sizeof(U) * 8; shift += 8) {
+        std::fill(std::begin(counts), std::end(counts), 0);
+        for(const auto &p : v)
+            counts[(p.first >> shift) & 0xff]++;
+
+        if(std::find(std::begin(counts), std::end(counts), v.size()) != std::end(counts))
+            continue;
+
+        std::size_t offset = 0;
+        for(std::size_t &count : counts) {
+            std::size_t c = count;
+            count = offset;
+            offset += c;
+        }
+
+        for(const auto &p : v)
+            buffer[counts[(p.first >> shift) & 0xff]++] = p;
+        v.swap(buffer);
+    }
+}
+
+
+// a stable sort which sorts chunks of the range on threads, then merges pairs of them
+// on threads until one is left
+template<typename It, typename Comp>
+void parallel_stable_sort(It first, It last, Comp &comp, std::size_t threads) {
+    using V = typename std::iterator_traits<It>::value_type;
+    std::size_t n = static_cast<std::size_t>(last - first);
+
+    if(threads <= 1 || n < parallel_sort_min || !std::is_default_constructible<V>::value) {
+        std::stable_sort(first, last, comp);
+        return;
+    }
+
+    if constexpr(std::is_default_constructible<V>::value) {
+        std::size_t chunks = 1;
+        while(chunks < threads && n / (chunks * 2) >= parallel_sort_min / 4)
+            chunks *= 2;
+
+        auto bound = [&](std::size_t c) { return first + static_cast<std::ptrdiff_t>(n * c / chunks); };
+        thread_pool pool(std::min(threads, chunks));
+
+        pool.run(chunks, [&](std::size_t c) { std::stable_sort(bound(c), bound(c + 1), comp); });
+
+        std::vector<V> buffer(n);
+        bool in_buffer = false;
+        for(std::size_t width = 1; width < chunks; width *= 2) {
+            pool.run(chunks / (2 * width), [&](std::size_t pair) {
+                std::size_t lo = n * (pair * 2 * width) / chunks;
+                std::size_t mid = n * (pair * 2 * width + width) / chunks;
+                std::size_t hi = n * (pair * 2 * width + 2 * width) / chunks;
+                if(in_buffer) {
+                    auto b = buffer.begin();
+                    std::merge(std::make_move_iterator(b + lo), std::make_move_iterator(b + mid),
+                               std::make_move_iterator(b + mid), std::make_move_iterator(b + hi),
+                               first + lo, comp);
+                } else {
+                    std::merge(std::make_move_iterator(first + lo), std::make_move_iterator(first + mid),
+                               std::make_move_iterator(first + mid), std::make_move_iterator(first + hi),
+                               buffer.begin() + lo, comp);
+                }
+            });
+            in_buffer = !in_buffer;
+        }
+
+        if(in_buffer)
+            std::move(buffer.begin(), buffer.end(), first);
+    }
+}
+
+
+// puts values in the order of the indexes in decorated
+template<typename T, typename Decorated>
+void undecorate(std::vector<T> &values, const std::vector<Decorated> &decorated) {
+    std::vector<T> out;
+    out.reserve(values.size());
+    for(const auto &d : decorated)
+        out.push_back(std::move(values[d.second]));
+    values.swap(out);
+}
+
+
+// how key(value) is kept next to value, so that it is worked out only once: by address
+// if key returns a reference into the value, and copied otherwise
+template<typename T, typename KeyFunc>
+struct stored_key {
+    using R = decltype(std::declval<KeyFunc&>()(std::declval<const T&>()));
+    using K = typename remove_ref_cv<R>::type;
+    using type = typename std::conditional<std::is_lvalue_reference<R>::value, const K*, K>::type;
+
+    static type make(KeyFunc &key, const T &value) {
+        if constexpr(std::is_lvalue_reference<R>::value)
+            return &key(value);
+        else
+            return key(value);
+    }
+
+    static const K &get(const type &stored) {
+        if constexpr(std::is_lvalue_reference<R>::value)
+            return *stored;
+        else
+            return stored;
+    }
+};
+
+
+// sorts values by key(value), working out each key only once. arithmetic keys ordered by
+// std::less or std::greater are radix sorted, other keys are kept as stored_key says.
+template<typename T, typename KeyFunc, typename Comp>
+void sort_by_key(std::vector<T> &values, KeyFunc &key, Comp &comp, std::size_t threads) {
+    using R = decltype(key(std::declval<const T&>()));
+    using K = typename remove_ref_cv<R>::type;
+
+    if constexpr(radix_order<K, Comp>::value) {
+        using U = decltype(radix_bits(std::declval<K>()));
+        std::vector<std::pair<U, std::size_t> > decorated;
+        decorated.reserve(values.size());
+        for(std::size_t i = 0; i < values.size(); i++) {
+            U bits = radix_bits<K>(key(static_cast<const T&>(values[i])));
+            decorated.emplace_back(radix_order<K, Comp>::descending ? U(~bits) : bits, i);
+        }
+        radix_sort(decorated);
+        undecorate(values, decorated);
+    } else {
+        using Stored = stored_key<T, KeyFunc>;
+        auto &&key_comp = less_or_default<K>(comp);
+
+        std::vector<std::pair<typename Stored::type, std::size_t> > decorated;
+        decorated.reserve(values.size());
+        for(std::size_t i = 0; i < values.size(); i++)
+            decorated.emplace_back(Stored::make(key, values[i]), i);
+
+        using D = std::pair<typename Stored::type, std::size_t>;
+        auto by_key = [&key_comp](const D &a, const D &b) {
+            return key_comp(Stored::get(a.first), Stored::get(b.first));
+        };
+        parallel_stable_sort(decorated.begin(), decorated.end(), by_key, threads);
+        undecorate(values, decorated);
+    }
+}
+
+
+// sorts values by comp, which compares whole elements
+template<typename T, typename Comp>
+void sort_by_comp(std::vector<T> &values, Comp &comp, std::size_t threads) {
+    if constexpr(radix_order<T, Comp>::value) {
+        identity<T> key;
+        sort_by_key(values, key, comp, threads);
+    } else {
+        auto &&value_comp = less_or_default<T>(comp);
+        parallel_stable_sort(values.begin(), values.end(), value_comp, threads);
+    }
+}
+
+
+template<typename KeyFunc, typename Comp>
+class key_sorter {
+public:
+    key_sorter(KeyFunc &&k, Comp &&c) : key(std::move(k)), comp(std::move(c)) {}
+
+    template<typename T>
+    void operator()(std::vector<T> &values, std::size_t threads) { sort_by_key(values, key, comp, threads); }
+
+    // what less<T> compares, worked out once per element
+    template<typename T>
+    using stored = typename stored_key<T, KeyFunc>::type;
+
+    template<typename T>
+    stored<T> store(const T &value) { return stored_key<T, KeyFunc>::make(key, value); }
+
+    template<typename T>
+    bool less(const stored<T> &a, const stored<T> &b) {
+        using Stored = stored_key<T, KeyFunc>;
+        if constexpr(std::is_same<Comp, default_less>::value)
+            return std::less<typename Stored::K>()(Stored::get(a), Stored::get(b));
+        else
+            return comp(Stored::get(a), Stored::get(b));
+    }
+
+private:
+    KeyFunc key;
+    Comp comp;
+};
+
+
+template<typename Comp>
+class comp_sorter {
+public:
+    comp_sorter(Comp &&c) : comp(std::move(c)) {}
+
+    template<typename T>
+    void operator()(std::vector<T> &values, std::size_t threads) { sort_by_comp(values, comp, threads); }
+
+    template<typename T>
+    using stored = const T*;
+
+    template<typename T>
+    stored<T> store(const T &value) { return &value; }
+
+    template<typename T>
+    bool less(const T *a, const T *b) {
+        if constexpr(std::is_same<Comp, default_less>::value)
+            return std::less<T>()(*a, *b);
+        else
+            return comp(*a, *b);
+    }
+
+private:
+    Comp comp;
+};
+
+
+// reads the whole of the previous step and sorts it when the first element is asked for.
+// if limit() says only the first n elements are wanted, only the n smallest are kept as
+// they arrive. otherwise, elements pulled one at a time come off a heap, so taking the
+// first few costs O(n + k log n) rather than a full sort.
+template<typename T, typename Sorter>
+class sort_step : public step<T> {
+public:
+    sort_step(std::unique_ptr<step<T> > &&s, Sorter &&sort_func, std::size_t thread_count)
+        : source(std::move(s)), sorter(std::move(sort_func)), threads(thread_count),
+          wanted(std::numeric_limits<std::size_t>::max()), values(), heap(), sorted() {}
+
+    std::optional<T> get() override {
+        if(source && !limited())
+            make_heap();
+        if(!sorted && !source)
+            return pop();
+        return ready().get();
+    }
+
+    std::size_t get_batch(T *out, std::size_t n) override { return ready().get_batch(out, n); }
+
+    void push(sink<T> &out) override { ready().push(out); }
+
+    std::size_t discard(std::size_t n) override {
+        if(!sorted && !source) {
+            std::size_t i = 0;
+            for(; i < n && pop(); i++) {}
+            return i;
+        }
+        return ready().discard(n);
+    }
+
+    size_hint hint() const override {
+        if(sorted)
+            return sorted->hint();
+        if(!source)
+            return {size_hint::exact, heap.size()};
+        return source->hint();
+    }
+
+    void limit(std::size_t n) override {
+        if(source)
+            wanted = std::min(wanted, n);
+    }
+
+    bool indexable() const override { return sorted && sorted->indexable(); }
+
+    T at(std::size_t i) override { return sorted->at(i); }
+
+private:
+    // what the sorter compares, worked out once per element and kept next to it
+    using stored = typename Sorter::template stored<T>;
+
+    // an order with no ties: equal elements are ordered by when they arrived, which
+    // keeps selecting and heaps stable
+    bool before(const stored &a, std::size_t a_pos, const stored &b, std::size_t b_pos) {
+        if(sorter.template less<T>(a, b))
+            return true;
+        return !sorter.template less<T>(b, a) && a_pos < b_pos;
+    }
+
+    // limits of half the largest size_t or more are as good as none
+    bool limited() const { return wanted < std::numeric_limits<std::size_t>::max() / 2; }
+
+    step<T> &ready() {
+        if(!sorted) {
+            std::vector<T> out;
+            if(!source)
+                out = from_heap();
+            else if(limited() && !(source->hint().is_exact() && source->hint().size <= wanted))
+                out = select();
+            else
+                out = sort_all();
+            sorted.reset(new cont_source<std::vector<T>, T>(std::move(out)));
+        }
+        return *sorted;
+    }
+
+    std::vector<T> sort_all() {
+        vector_collector<T> out;
+        out.reserve(source->hint());
+        source->push(out);
+        source.reset();
+
+        std::vector<T> result = out.result();
+        sorter(result, threads);
+        return result;
+    }
+
+    // keeps the first wanted elements in sorted order. whenever enough more than that
+    // are held, the rest are dropped, which is O(n) over the whole stream.
+    std::vector<T> select() {
+        select_sink out(*this, wanted);
+        if(wanted > 0)
+            source->push(out);
+        source.reset();
+        return out.result();
+    }
+
+    // the elements stay where they were put in slots, which a deque does not move, so
+    // that what is stored for them stays valid. only the entries are selected from, and
+    // the slots of those dropped are reused.
+    class select_sink : public collector_sink<select_sink, T> {
+    public:
+        select_sink(sort_step &s, std::size_t count)
+            : owner(s), n(count), most(n + std::max<std::size_t>(n, 64)), slots(), unused(), kept(), pos(0) {}
+
+        bool on_next(T &&value) override {
+            std::size_t slot = slots.size();
+            if(unused.empty()) {
+                slots.emplace_back(std::move(value));
+            } else {
+                slot = unused.back();
+                unused.pop_back();
+                slots[slot].emplace(std::move(value));
+            }
+            kept.push_back(entry{owner.sorter.store(*slots[slot]), pos++, slot});
+            if(kept.size() == most)
+                trim();
+            return true;
+        }
+
+        std::vector<T> result() {
+            if(kept.size() > n)
+                trim();
+            std::sort(kept.begin(), kept.end(), by_order());
+
+            std::vector<T> out;
+            out.reserve(kept.size());
+            for(const entry &e : kept)
+                out.push_back(*std::move(slots[e.slot]));
+            return out;
+        }
+
+    private:
+        struct entry {
+            stored key;
+            std::size_t pos;
+            std::size_t slot;
+        };
+
+        auto by_order() {
+            return [this](const entry &a, const entry &b) { return owner.before(a.key, a.pos, b.key, b.pos); };
+        }
+
+        void trim() {
+            std::nth_element(kept.begin(), kept.begin() + n, kept.end(), by_order());
+            for(auto it = kept.begin() + n; it != kept.end(); ++it) {
+                slots[it->slot].reset();
+                unused.push_back(it->slot);
+            }
+            kept.erase(kept.begin() + n, kept.end());
+        }
+
+        sort_step &owner;
+        std::size_t n;
+        std::size_t most;
+        std::deque<std::optional<T> > slots;
+        std::vector<std::size_t> unused;
+        std::vector<entry> kept;
+        std::size_t pos;
+    };
+
+    // heap holds what is stored for each element of values along with its index, with
+    // the first of them in sorted order on top
+    auto after() {
+        return [this](const std::pair<stored, std::size_t> &a, const std::pair<stored, std::size_t> &b) {
+            return before(b.first, b.second, a.first, a.second);
+        };
+    }
+
+    void make_heap() {
+        vector_collector<T> out;
+        out.reserve(source->hint());
+        source->push(out);
+        source.reset();
+
+        values = out.result();
+        heap.reserve(values.size());
+        for(std::size_t i = 0; i < values.size(); i++)
+            heap.emplace_back(sorter.store(values[i]), i);
+        std::make_heap(heap.begin(), heap.end(), after());
+    }
+
+    std::optional<T> pop() {
+        if(heap.empty())
+            return {};
+        std::pop_heap(heap.begin(), heap.end(), after());
+        T value = std::move(values[heap.back().second]);
+        heap.pop_back();
+        return {std::move(value)};
+    }
+
+    // what is left on the heap, in sorted order
+    std::vector<T> from_heap() {
+        std::sort_heap(heap.begin(), heap.end(), after());
+        std::vector<T> result;
+        result.reserve(heap.size());
+        for(auto it = heap.rbegin(); it != heap.rend(); ++it)
+            result.push_back(std::move(values[it->second]));
+        values.clear();
+        heap.clear();
+        return result;
+    }
+
+    std::unique_ptr<step<T> > source;
+    Sorter sorter;
+    std::size_t threads;
+    std::size_t wanted;
+    std::vector<T> values;
+    std::vector<std::pair<stored, std::size_t> > heap;
+    std::unique_ptr<step<T> > sorted;
+};
+
+
+template<typename Sorter>
+class sorted_custom_t : public step_wrapper<sorted_custom_t<Sorter> > {
+public:
+    sorted_custom_t(Sorter &&s, std::size_t thread_count) : sorter(std::move(s)), threads(thread_count) {}
+
+    template<typename T>
+    streamer_t<T> &&stream(streamer_t<T> &st, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use sorted on an unbounded stream");
+
+        s.reset(new sort_step<T, Sorter>(std::move(s), std::move(sorter), threads));
+        return std::move(st);
+    }
+
+private:
+    Sorter sorter;
+    std::size_t threads;
+};
+
+
+class sorted_t : public step_wrapper<sorted_t> {
+public:
+    constexpr sorted_t &operator()() noexcept { return *this; }
+
+    // large inputs are only sorted on more than one thread if threads says so, since the
+    // comparison or key is then called from several threads at once
+    auto operator()(std::size_t threads) {
+        return sorted_custom_t(comp_sorter(default_less()), threads);
+    }
+
+    // a member pointer is used as the key, anything else as a comparison of whole elements
+    template<typename CompOrMem, typename = typename std::enable_if<!std::is_integral<CompOrMem>::value>::type>
+    auto operator()(CompOrMem comp, std::size_t threads = 1) {
+        if constexpr(std::is_member_pointer<CompOrMem>::value)
+            return sorted_custom_t(key_sorter(member_mapper(comp), default_less()), threads);
+        else
+            return sorted_custom_t(comp_sorter(member_comparer(std::move(comp))), threads);
+    }
+
+    template<typename KeyFunc, typename Comp, typename = typename std::enable_if<!std::is_integral<Comp>::value>::type>
+    auto operator()(KeyFunc k, Comp comp, std::size_t threads = 1) {
+        return sorted_custom_t(key_sorter(member_mapper(std::move(k)), std::move(comp)), threads);
+    }
+
+    template<typename T>
+    streamer_t<T> &&stream(streamer_t<T> &st, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        return sorted_custom_t(comp_sorter(default_less()), 1).stream(st, s, unbounded);
+    }
+};
+
+
+} // namespace detail
+
+
+static detail::sorted_t sorted;
+
+
+namespace detail {
+    inline void sorted_unused_warnings() {
+        sorted();
+    }
+} // namespace detail
+
+} // namespace streamer
+
+#endif
@@ -2,6 +2,7 @@
 #define STREAMER_STACK_HPP
 
 #include "base.hpp"
+#include "deque.hpp"
 #include <deque>
 #include <stack>
 
@@ -17,11 +18,13 @@ public:
     constexpr as_stack_t &operator()() noexcept { return *this; }
 
     template<typename T>
-    std::stack<T> stream(streamer_t<T> &st, std::unique_ptr<step<T> > &, bool &unbounded) {
+    std::stack<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
         if(unbounded)
             throw unbounded_stream("cannot use as_stack on an unbounded stream");
 
-        return std::stack<T>(std::deque<T>(st.begin(), st.end()));
+        deque_collector<T> out;
+        s->push(out);
+        return std::stack<T>(out.result());
     }
 };
 
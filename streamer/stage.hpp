@@ -0,0 +1,36 @@
+#ifndef STREAMER_STAGE_HPP
+#define STREAMER_STAGE_HPP
+
+#include "base.hpp"
+#include "prefetch.hpp"
+#include <stdexcept>
+
+
+namespace streamer {
+
+
+// splits the stream in two: the steps before it, back to the previous stage(), run on a
+// thread of their own, and hand their elements to the steps after it through a ring of
+// capacity elements. with cpu, the thread is kept on that cpu where the system allows.
+class stage : public detail::step_wrapper<stage> {
+public:
+    explicit stage(std::size_t capacity = 1024, int cpu = -1) : cap(capacity), pinned(cpu) {
+        if(cap == 0)
+            throw std::invalid_argument("the capacity of a stage must be at least 1");
+    }
+
+    template<typename T>
+    streamer_t<T> &&stream(streamer_t<T> &st, std::unique_ptr<detail::step<T> > &s, bool &) {
+        s.reset(new detail::prefetch_step<T>(cap, pinned, std::move(s)));
+        return std::move(st);
+    }
+
+private:
+    std::size_t cap;
+    int pinned;
+};
+
+
+} // namespace streamer
+
+#endif
@@ -4,6 +4,6 @@
 #include "base.hpp"
 #include "base_steps.hpp"
 #include "base_filter.hpp"
+#include "fused.hpp"
 
 #endif
-
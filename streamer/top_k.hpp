@@ -0,0 +1,182 @@
+#ifndef STREAMER_TOP_K_HPP
+#define STREAMER_TOP_K_HPP
+
+#include "base.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+// compares the other way around, so the largest elements come first
+template<typename Comp>
+class greater_by {
+public:
+    greater_by(Comp &&c) : comp(std::move(c)) {}
+
+    template<typename A, typename B>
+    bool operator()(const A &a, const B &b) { return comp(b, a); }
+
+private:
+    Comp comp;
+};
+
+
+// keeps the first k elements by Comp in a heap with the last of them on top, so every
+// other element is compared with just that one. equal elements are ordered by when they
+// arrived, so the result is the same as a stable sort followed by take(k).
+template<typename Comp, typename T>
+class top_k_collector : public collector_sink<top_k_collector<Comp, T>, T> {
+public:
+    top_k_collector(std::size_t count, Comp &&c) : k(count), comp(std::move(c)), heap(), pos(0) {}
+
+    bool on_next(T &&value) override {
+        if(heap.size() < k) {
+            heap.emplace_back(std::move(value), pos++);
+            std::push_heap(heap.begin(), heap.end(), before());
+        } else if(k > 0 && comp(value, heap.front().first)) {
+            std::pop_heap(heap.begin(), heap.end(), before());
+            heap.back() = {std::move(value), pos++};
+            std::push_heap(heap.begin(), heap.end(), before());
+        } else {
+            pos++;
+        }
+        return k > 0;
+    }
+
+    // the kept elements, first to last
+    std::vector<T> result() {
+        std::sort_heap(heap.begin(), heap.end(), before());
+
+        std::vector<T> out;
+        out.reserve(heap.size());
+        for(auto &p : heap)
+            out.push_back(std::move(p.first));
+        heap.clear();
+        return out;
+    }
+
+private:
+    auto before() {
+        return [this](const std::pair<T, std::size_t> &a, const std::pair<T, std::size_t> &b) {
+            if(comp(a.first, b.first))
+                return true;
+            return !comp(b.first, a.first) && a.second < b.second;
+        };
+    }
+
+    std::size_t k;
+    Comp comp;
+    std::vector<std::pair<T, std::size_t> > heap;
+    std::size_t pos;
+};
+
+
+// Largest picks the k largest elements by Comp, largest first. otherwise the k smallest,
+// smallest first.
+template<typename Comp, bool Largest>
+class top_k_t : public step_wrapper<top_k_t<Comp, Largest> > {
+public:
+    top_k_t(std::size_t count, Comp &&c) : k(count), comp(std::move(c)) {}
+
+    template<typename T>
+    std::vector<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream(Largest ? "cannot use top_k on an unbounded stream"
+                                           : "cannot use bottom_k on an unbounded stream");
+
+        auto out = collector<T>();
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    auto collector() {
+        auto c = less_or_default<T>(std::move(comp));
+        if constexpr(Largest)
+            return top_k_collector<greater_by<decltype(c)>, T>(k, greater_by<decltype(c)>(std::move(c)));
+        else
+            return top_k_collector<decltype(c), T>(k, std::move(c));
+    }
+
+    // each chunk keeps its own k elements on its thread. they are then merged in the
+    // order of the chunks, which keeps equal elements in stream order.
+    template<typename T, typename Pipeline>
+    auto run(parallel_streamer_t<T, Pipeline> &&p) {
+        using U = typename parallel_streamer_t<T, Pipeline>::value_type;
+        using Collector = decltype(collector<U>());
+
+        auto make = [this]() { return copy().template collector<U>(); };
+        Collector merged(make());
+        collect_chunks(p, make, [&merged](Collector &partial) {
+            for(U &value : partial.result())
+                merged.on_next(std::move(value));
+        });
+        return merged.result();
+    }
+
+private:
+    top_k_t copy() const {
+        Comp c(comp);
+        return top_k_t(k, std::move(c));
+    }
+
+    std::size_t k;
+    Comp comp;
+};
+
+
+template<typename Comp, bool Largest>
+struct parallel_terminal<top_k_t<Comp, Largest> > : std::true_type {};
+
+
+}  // namespace detail
+
+
+
+// the k largest elements, largest first
+inline auto top_k(std::size_t k) {
+    return detail::top_k_t<detail::default_less, true>(k, detail::default_less());
+}
+
+template<typename Comp>
+auto top_k(std::size_t k, Comp comp) {
+    auto c = detail::member_comparer(std::move(comp));
+    return detail::top_k_t<decltype(c), true>(k, std::move(c));
+}
+
+template<typename KeyFunc, typename Comp>
+auto top_k(std::size_t k, KeyFunc keyFunc, Comp comp) {
+    auto c = detail::member_comparer_custom(keyFunc, std::move(comp));
+    return detail::top_k_t<decltype(c), true>(k, std::move(c));
+}
+
+
+// the k smallest elements, smallest first
+inline auto bottom_k(std::size_t k) {
+    return detail::top_k_t<detail::default_less, false>(k, detail::default_less());
+}
+
+template<typename Comp>
+auto bottom_k(std::size_t k, Comp comp) {
+    auto c = detail::member_comparer(std::move(comp));
+    return detail::top_k_t<decltype(c), false>(k, std::move(c));
+}
+
+template<typename KeyFunc, typename Comp>
+auto bottom_k(std::size_t k, KeyFunc keyFunc, Comp comp) {
+    auto c = detail::member_comparer_custom(keyFunc, std::move(comp));
+    return detail::top_k_t<decltype(c), false>(k, std::move(c));
+}
+
+
+} // namespace streamer
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef STREAMER_UNORDERED_MAP_HPP
+#define STREAMER_UNORDERED_MAP_HPP
+
+#include "base.hpp"
+#include "flat_hash.hpp"
+#include "map.hpp"
+#include <unordered_map>
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+// Map is a std::unordered_map or a flat_hash_map
+template<typename Map, typename KeyFunc, typename ValueFunc, typename T>
+class hash_map_collector : public collector_sink<hash_map_collector<Map, KeyFunc, ValueFunc, T>, T> {
+public:
+    using K = typename Map::key_type;
+
+    hash_map_collector(KeyFunc &&keyFunc, ValueFunc &&valueFunc, Map &&m, bool throw_on_dup)
+        : k(std::move(keyFunc)), v(std::move(valueFunc)), out(std::move(m)), dup_throw(throw_on_dup) {}
+
+    // the key value would be stored under
+    decltype(auto) key(T &value) { return k(value); }
+
+    bool on_next(T &&value) override {
+        // the key is only copied, and the value only worked out, when the key is new. the
+        // key is stored first, so it may refer into value.
+        auto &&key = k(value);
+        if(!out.try_emplace(std::forward<decltype(key)>(key), new_value{*this, value}).second && dup_throw)
+            throw duplicate_map_key("key already exists in map");
+        return true;
+    }
+
+    // duplicate keys can make this more than is needed
+    void reserve(size_hint hint) {
+        if(hint.is_exact())
+            out.reserve(out.size() + hint.size);
+    }
+
+    Map result() { return std::move(out); }
+
+private:
+    // becomes the value stored for a new key
+    struct new_value {
+        hash_map_collector &owner;
+        T &value;
+
+        operator typename Map::mapped_type() { return owner.v(std::move(value)); }
+    };
+
+    KeyFunc k;
+    ValueFunc v;
+    Map out;
+    bool dup_throw;
+};
+
+
+template<template<typename...> class MapT, typename KeyFunc, typename ValueFunc, typename Hash, typename Eq>
+class as_hash_map_t : public step_wrapper<as_hash_map_t<MapT, KeyFunc, ValueFunc, Hash, Eq> > {
+public:
+    as_hash_map_t(KeyFunc &&keyFunc, ValueFunc &&valueFunc, Hash &&hash, Eq &&eq, bool throw_on_dup)
+        : k(std::move(keyFunc)), v(std::move(valueFunc)), h(std::move(hash)), e(std::move(eq)), dup_throw(throw_on_dup) {}
+
+    template<typename T>
+    auto stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use as_unordered_map on an unbounded stream");
+
+        auto out = collector<T>();
+        out.reserve(s->hint());
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    auto collector() {
+        using K = typename remove_ref_cv<decltype(k(std::declval<T&>()))>::type;
+        auto hash = hash_or_default<K>(std::move(h));
+        auto eq = equal_to_or_default<K>(std::move(e));
+
+        if constexpr(std::is_same<ValueFunc, element_value>::value) {
+            using Map = MapT<K, T, decltype(hash), decltype(eq)>;
+            return hash_map_collector<Map, KeyFunc, identity<T>, T>(
+                std::move(k), identity<T>(), Map(0, std::move(hash), std::move(eq)), dup_throw);
+        } else {
+            using V = typename remove_ref_cv<decltype(v(std::declval<T>()))>::type;
+            using Map = MapT<K, V, decltype(hash), decltype(eq)>;
+            return hash_map_collector<Map, KeyFunc, ValueFunc, T>(
+                std::move(k), std::move(v), Map(0, std::move(hash), std::move(eq)), dup_throw);
+        }
+    }
+
+private:
+    KeyFunc k;
+    ValueFunc v;
+    Hash h;
+    Eq e;
+    bool dup_throw;
+};
+
+
+template<template<typename...> class MapT, typename KeyFunc, typename ValueFunc, typename Hash, typename Eq>
+auto as_hash_map(KeyFunc &&k, ValueFunc &&v, Hash &&h, Eq &&e, bool throw_on_dup) {
+    return as_hash_map_t<MapT, KeyFunc, ValueFunc, Hash, Eq>(
+        std::move(k), std::move(v), std::move(h), std::move(e), throw_on_dup);
+}
+
+
+}  // namespace detail
+
+
+
+template<typename KeyFunc, typename ValueFunc, typename Hash, typename Eq>
+auto as_unordered_map(KeyFunc k, ValueFunc v, Hash h, Eq e, bool throw_on_dup = true) {
+    return detail::as_hash_map<std::unordered_map>(
+        detail::member_mapper(std::move(k)),
+        detail::member_mapper(std::move(v)),
+        std::move(h),
+        std::move(e),
+        throw_on_dup
+    );
+}
+
+
+template<typename KeyFunc, typename ValueFunc>
+auto as_unordered_map(KeyFunc k, ValueFunc v, bool throw_on_dup = true) {
+    return detail::as_hash_map<std::unordered_map>(
+        detail::member_mapper(std::move(k)),
+        detail::member_mapper(std::move(v)),
+        detail::default_hash(),
+        detail::default_equal_to(),
+        throw_on_dup
+    );
+}
+
+
+template<typename KeyFunc>
+auto as_unordered_map(KeyFunc k, bool throw_on_dup = true) {
+    return detail::as_hash_map<std::unordered_map>(
+        detail::member_mapper(std::move(k)),
+        detail::element_value(),
+        detail::default_hash(),
+        detail::default_equal_to(),
+        throw_on_dup
+    );
+}
+
+
+
+template<typename KeyFunc, typename ValueFunc, typename Hash, typename Eq>
+auto as_flat_hash_map(KeyFunc k, ValueFunc v, Hash h, Eq e, bool throw_on_dup = true) {
+    return detail::as_hash_map<flat_hash_map>(
+        detail::member_mapper(std::move(k)),
+        detail::member_mapper(std::move(v)),
+        std::move(h),
+        std::move(e),
+        throw_on_dup
+    );
+}
+
+
+template<typename KeyFunc, typename ValueFunc>
+auto as_flat_hash_map(KeyFunc k, ValueFunc v, bool throw_on_dup = true) {
+    return detail::as_hash_map<flat_hash_map>(
+        detail::member_mapper(std::move(k)),
+        detail::member_mapper(std::move(v)),
+        detail::default_hash(),
+        detail::default_equal_to(),
+        throw_on_dup
+    );
+}
+
+
+template<typename KeyFunc>
+auto as_flat_hash_map(KeyFunc k, bool throw_on_dup = true) {
+    return detail::as_hash_map<flat_hash_map>(
+        detail::member_mapper(std::move(k)),
+        detail::element_value(),
+        detail::default_hash(),
+        detail::default_equal_to(),
+        throw_on_dup
+    );
+}
+
+
+} // namespace streamer
+
+#endif
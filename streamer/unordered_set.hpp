@@ -0,0 +1,132 @@
+#ifndef STREAMER_UNORDERED_SET_HPP
+#define STREAMER_UNORDERED_SET_HPP
+
+#include "base.hpp"
+#include "flat_hash.hpp"
+#include "set.hpp"
+#include <unordered_set>
+
+
+namespace streamer {
+
+
+namespace detail {
+
+
+// Set is a std::unordered_set or a flat_hash_set
+template<typename Set, typename T>
+class hash_set_collector : public collector_sink<hash_set_collector<Set, T>, T> {
+public:
+    hash_set_collector(Set &&s, bool throw_on_dup) : out(std::move(s)), dup_throw(throw_on_dup) {}
+
+    bool on_next(T &&value) override {
+        if(!out.insert(std::move(value)).second && dup_throw)
+            throw duplicate_set_key("value already exists in set");
+        return true;
+    }
+
+    void reserve(size_hint hint) {
+        if(hint.is_exact())
+            out.reserve(out.size() + hint.size);
+    }
+
+    Set result() { return std::move(out); }
+
+private:
+    Set out;
+    bool dup_throw;
+};
+
+
+template<template<typename...> class SetT, typename Hash, typename Eq>
+class as_hash_set_custom_t : public step_wrapper<as_hash_set_custom_t<SetT, Hash, Eq> > {
+public:
+    as_hash_set_custom_t(Hash &&hash, Eq &&eq, bool throw_on_dup)
+        : h(std::move(hash)), e(std::move(eq)), dup_throw(throw_on_dup) {}
+
+    template<typename T>
+    auto stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        if(unbounded)
+            throw unbounded_stream("cannot use as_unordered_set on an unbounded stream");
+
+        auto out = collector<T>();
+        out.reserve(s->hint());
+        s->push(out);
+        return out.result();
+    }
+
+    template<typename T>
+    auto collector() {
+        auto hash = hash_or_default<T>(std::move(h));
+        auto eq = equal_to_or_default<T>(std::move(e));
+        using Set = SetT<T, decltype(hash), decltype(eq)>;
+        return hash_set_collector<Set, T>(Set(0, std::move(hash), std::move(eq)), dup_throw);
+    }
+
+private:
+    Hash h;
+    Eq e;
+    bool dup_throw;
+};
+
+
+template<template<typename...> class SetT>
+class as_hash_set_t : public step_wrapper<as_hash_set_t<SetT> > {
+public:
+    as_hash_set_t(bool throw_on_dup = true) : dup_throw(throw_on_dup) {}
+
+    as_hash_set_t operator()(bool throw_on_dup = true) noexcept {
+        return as_hash_set_t(throw_on_dup);
+    }
+
+    // elements are hashed and compared by the key k returns, which may be a member pointer
+    template<typename KeyFunc>
+    auto operator()(KeyFunc k, bool throw_on_dup = true) {
+        auto key = member_mapper(std::move(k));
+        using Key = decltype(key);
+        return custom(key_hasher<Key, default_hash>{key, default_hash()},
+                      key_equal<Key, default_equal_to>{key, default_equal_to()}, throw_on_dup);
+    }
+
+    template<typename Hash, typename Eq>
+    auto operator()(Hash hash, Eq eq, bool throw_on_dup = true) {
+        return custom(std::move(hash), std::move(eq), throw_on_dup);
+    }
+
+    template<typename T>
+    auto stream(streamer_t<T> &st, std::unique_ptr<step<T> > &s, bool &unbounded) {
+        return custom(default_hash(), default_equal_to(), dup_throw).stream(st, s, unbounded);
+    }
+
+    template<typename T>
+    auto collector() {
+        return custom(default_hash(), default_equal_to(), dup_throw).template collector<T>();
+    }
+
+private:
+    template<typename Hash, typename Eq>
+    static auto custom(Hash &&hash, Eq &&eq, bool throw_on_dup) {
+        return as_hash_set_custom_t<SetT, Hash, Eq>(std::move(hash), std::move(eq), throw_on_dup);
+    }
+
+    bool dup_throw;
+};
+
+
+}  // namespace detail
+
+
+static detail::as_hash_set_t<std::unordered_set> as_unordered_set;
+static detail::as_hash_set_t<flat_hash_set> as_flat_hash_set;
+
+
+namespace detail {
+    inline void unordered_set_unused_warnings() {
+        as_unordered_set();
+        as_flat_hash_set();
+    }
+} // namespace detail
+
+} // namespace streamer
+
+#endif
@@ -12,17 +12,54 @@ namespace streamer {
 namespace detail {
 
     
+template<typename T>
+class vector_collector : public sink<T> {
+public:
+    bool on_next(T &&value) override {
+        out.push_back(std::move(value));
+        return true;
+    }
+
+    bool on_batch(T *values, std::size_t n) override {
+        if constexpr(batchable<T>::value) {
+            out.insert(out.end(), std::make_move_iterator(values), std::make_move_iterator(values + n));
+            return true;
+        } else {
+            return sink<T>::on_batch(values, n);
+        }
+    }
+
+    // only exact sizes are reserved. an upper bound (after a filter, say) can be
+    // far larger than what actually arrives.
+    void reserve(size_hint hint) {
+        if(hint.is_exact())
+            out.reserve(out.size() + hint.size);
+    }
+
+    std::vector<T> result() { return std::move(out); }
+
+private:
+    std::vector<T> out;
+};
+
+
 class as_vector_t : public step_wrapper<as_vector_t> {
 public:
     constexpr as_vector_t &operator()() noexcept { return *this; }
 
     template<typename T>
-    std::vector<T> stream(streamer_t<T> &st, std::unique_ptr<step<T> > &, bool &unbounded) {
+    std::vector<T> stream(streamer_t<T> &, std::unique_ptr<step<T> > &s, bool &unbounded) {
         if(unbounded)
             throw unbounded_stream("cannot use as_vector on an unbounded stream");
 
-        return std::vector<T>(st.begin(), st.end());
+        auto out = collector<T>();
+        out.reserve(s->hint());
+        s->push(out);
+        return out.result();
     }
+
+    template<typename T>
+    vector_collector<T> collector() { return vector_collector<T>(); }
 };
 
 
@@ -2,21 +2,44 @@
 #include "examples/example_as_forward_list.cpp"
 #include "examples/example_as_list.cpp"
 #include "examples/example_as_map.cpp"
+#include "examples/example_stream_fused.cpp"
+#include "examples/example_stream_ref.cpp"
+#include "examples/example_parallel.cpp"
+#include "examples/example_parallel_fold.cpp"
+#include "examples/example_parallel_as_map.cpp"
+#include "examples/example_as_unordered_map.cpp"
+#include "examples/example_as_unordered_set.cpp"
+#include "examples/example_as_hash_grouping.cpp"
+#include "examples/example_as_flat_map.cpp"
+#include "examples/example_as_flat_set.cpp"
+#include "examples/example_sorted.cpp"
+#include "examples/example_top_k.cpp"
+#include "examples/example_nth.cpp"
+#include "examples/example_quantile_sketch.cpp"
+#include "examples/example_approx_distinct.cpp"
+#include "examples/example_heavy_hitters.cpp"
+#include "examples/example_group_reduce.cpp"
+#include "examples/example_aggregate.cpp"
+#include "examples/example_numeric.cpp"
+#include "examples/example_prefetch.cpp"
+#include "examples/example_stage.cpp"
+#include "examples/example_filter.cpp"
+#include "examples/example_as_vector.cpp"
+#include "examples/example_take.cpp"
+#include "examples/example_skip.cpp"
+#include "examples/example_last.cpp"
+#include "examples/example_item_count.cpp"
 /*#include "examples/example_as_multiset.cpp"
 #include "examples/example_as_queue.cpp"
 #include "examples/example_as_set.cpp"
 #include "examples/example_as_stack.cpp"
-#include "examples/example_as_vector.cpp"
 #include "examples/example_each.cpp"
 #include "examples/example_exclude.cpp"
-#include "examples/example_filter.cpp"
 #include "examples/example_first.cpp"
 #include "examples/example_flat_mapping.cpp"
 #include "examples/example_generator.cpp"
-#include "examples/example_item_count.cpp"
 #include "examples/example_iterator.cpp"
 #include "examples/example_join.cpp"
-#include "examples/example_last.cpp"
 #include "examples/example_mapping.cpp"
 #include "examples/example_or_default.cpp"
 #include "examples/example_or_get.cpp"
@@ -25,13 +48,11 @@
 //#include "examples/example_range_desc.cpp"
 #include "examples/example_reversed.cpp"
 #include "examples/example_single.cpp"
-#include "examples/example_skip.cpp"
 #include "examples/example_skip_while.cpp"
 #include "examples/example_stream.cpp"
 #include "examples/example_stream_empty.cpp"
 #include "examples/example_stream_move.cpp"
 #include "examples/example_stream_of.cpp"
-#include "examples/example_take.cpp"
 #include "examples/example_take_while.cpp"
 */
 
@@ -40,21 +61,44 @@ int main() {
     example_as_forward_list();
     example_as_list();
     example_as_map();
+    example_stream_fused();
+    example_stream_ref();
+    example_parallel();
+    example_parallel_fold();
+    example_parallel_as_map();
+    example_as_unordered_map();
+    example_as_unordered_set();
+    example_as_hash_grouping();
+    example_as_flat_map();
+    example_as_flat_set();
+    example_sorted();
+    example_top_k();
+    example_nth();
+    example_quantile_sketch();
+    example_approx_distinct();
+    example_heavy_hitters();
+    example_group_reduce();
+    example_aggregate();
+    example_numeric();
+    example_prefetch();
+    example_stage();
+    example_filter();
+    example_as_vector();
+    example_take();
+    example_skip();
+    example_last();
+    example_item_count();
 /*    example_as_multiset();
     example_as_queue();
     example_as_set();
     example_as_stack();
-    example_as_vector();
     example_each();
     example_exclude();
-    example_filter();
     example_first();
     example_flat_mapping();
     example_generator();
-    example_item_count();
     example_iterator();
     example_join();
-    example_last();
     example_mapping();
     example_or_default();
     example_or_get();
@@ -63,13 +107,11 @@ int main() {
 //    example_range_desc();
     example_reversed();
     example_single();
-    example_skip();
     example_skip_while();
     example_stream();
     example_stream_empty();
     example_stream_move();
     example_stream_of();
-    example_take();
     example_take_while();
  */   return 0;
 }